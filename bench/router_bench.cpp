@@ -0,0 +1,155 @@
+// Router equivalence check and micro-benchmark.
+//
+// Registers the service's route table twice: on Router, and as the
+// std::regex table httplib used to match against (first match wins, so
+// specific patterns come first). Every probe path must resolve to the same
+// route and captures in both. Then reports the per-request matching cost.
+//
+// Build with -DSTREAMING_BUILD_BENCHMARKS=ON and run ./build/router_bench.
+// Exits non-zero if any probe resolves differently.
+
+#include "api/router.h"
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Route {
+    std::string method;
+    std::string regex;      // as previously registered with httplib
+    std::string pattern;    // as registered with Router
+    std::vector<std::string> params;
+};
+
+const std::vector<Route> ROUTES = {
+    {"GET",     "/api/health",                          "/api/health",                      {}},
+    {"GET",     "/api/status",                          "/api/status",                      {}},
+    {"GET",     "/api/streams",                         "/api/streams",                     {}},
+    {"GET",     R"(/api/streams/(\w+)/thumbnail)",      "/api/streams/:name/thumbnail",     {"name"}},
+    {"GET",     R"(/api/streams/(\w+)/sprite)",         "/api/streams/:name/sprite",        {"name"}},
+    {"GET",     R"(/api/streams/(\w+))",                "/api/streams/:name",               {"name"}},
+    {"GET",     "/api/metrics",                         "/api/metrics",                     {}},
+    {"POST",    R"(/api/streams/(\w+)/publish)",        "/api/streams/:name/publish",       {"name"}},
+    {"POST",    R"(/api/streams/(\w+)/publish_done)",   "/api/streams/:name/publish_done",  {"name"}},
+    {"POST",    "/api/auth",                            "/api/auth",                        {}},
+    {"POST",    "/api/auth/keys",                       "/api/auth/keys",                   {}},
+    {"GET",     "/api/auth/keys",                       "/api/auth/keys",                   {}},
+    {"POST",    "/api/auth/keys/batch",                 "/api/auth/keys/batch",             {}},
+    {"POST",    "/api/auth/keys/import",                "/api/auth/keys/import",            {}},
+    {"POST",    "/api/auth/keys/revoke",                "/api/auth/keys/revoke",            {}},
+    {"DELETE",  R"(/api/auth/keys/(\w+))",              "/api/auth/keys/:key",              {"key"}},
+    {"OPTIONS", "/api/",                                "/api/",                            {}},
+    {"OPTIONS", R"(/api/(.+))",                         "/api/*path",                       {"path"}},
+    {"GET",     R"(/hls/ll/(\w+)/(.+))",                "/hls/ll/:name/*file",              {"name", "file"}},
+    {"GET",     R"(/hls/(.+))",                         "/hls/*file",                       {"file"}},
+    {"GET",     "/",                                    "/",                                {}},
+    {"GET",     "/streamingservice",                    "/streamingservice",                {}},
+    {"GET",     "/streamingservice/",                   "/streamingservice/",               {}},
+    {"GET",     R"(/static/(.+))",                      "/static/*path",                    {"path"}},
+};
+
+const std::vector<std::pair<std::string, std::string>> PROBES = {
+    {"GET", "/api/health"}, {"GET", "/api/status"}, {"GET", "/api/streams"},
+    {"GET", "/api/streams/stream"}, {"GET", "/api/streams/stream_2/thumbnail"},
+    {"GET", "/api/streams/stream/sprite"}, {"GET", "/api/streams/a-b"}, {"GET", "/api/streams/"},
+    {"GET", "/api/metrics"}, {"HEAD", "/api/status"},
+    {"POST", "/api/streams/stream/publish"}, {"POST", "/api/streams/stream/publish_done"},
+    {"POST", "/api/auth"}, {"POST", "/api/auth/keys"}, {"GET", "/api/auth/keys"},
+    {"POST", "/api/auth/keys/batch"}, {"POST", "/api/auth/keys/import"}, {"POST", "/api/auth/keys/revoke"},
+    {"DELETE", "/api/auth/keys/0123abcd"}, {"DELETE", "/api/auth/keys/a-b"}, {"GET", "/api/auth/keys/x"},
+    {"OPTIONS", "/api/"}, {"OPTIONS", "/api/streams/stream"}, {"OPTIONS", "/api"},
+    {"GET", "/hls/stream.m3u8"}, {"GET", "/hls/stream-123.ts"}, {"HEAD", "/hls/a/b.ts"}, {"GET", "/hls/"},
+    {"GET", "/hls/ll/stream/index.m3u8"}, {"GET", "/hls/ll/stream/seg12.3.m4s"},
+    {"GET", "/"}, {"GET", "/streamingservice"}, {"GET", "/streamingservice/"}, {"GET", "/streamingservicex"},
+    {"GET", "/static/player.3f2a1b4c.js"}, {"GET", "/static/"}, {"PUT", "/api/health"},
+};
+
+struct CompiledRoute {
+    const Route* route;
+    std::regex regex;
+};
+
+// Route index and captures the old regex table resolves to, or -1
+int regex_match(const std::vector<CompiledRoute>& table, const std::string& method,
+                const std::string& path, std::vector<std::string>& captures) {
+    const std::string& m = method == "HEAD" ? "GET" : method;
+    for (size_t i = 0; i < table.size(); ++i) {
+        std::smatch match;
+        if (table[i].route->method == m && std::regex_match(path, match, table[i].regex)) {
+            captures.assign(match.begin() + 1, match.end());
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+template <typename F>
+double ns_per_call(size_t iterations, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) f();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main() {
+    Router router;
+    std::vector<CompiledRoute> table;
+    for (size_t i = 0; i < ROUTES.size(); ++i) {
+        const Route& r = ROUTES[i];
+        // Each handler reports its route index through the response status
+        Router::Handler handler = [i](const httplib::Request&, httplib::Response& res, const RouteParams&) {
+            res.status = static_cast<int>(i);
+        };
+        if (r.method == "GET") router.Get(r.pattern, handler);
+        else if (r.method == "POST") router.Post(r.pattern, handler);
+        else if (r.method == "DELETE") router.Delete(r.pattern, handler);
+        else router.Options(r.pattern, handler);
+        table.push_back({&r, std::regex(r.regex)});
+    }
+
+    int mismatches = 0;
+    for (const auto& [method, path] : PROBES) {
+        std::vector<std::string> expected_captures;
+        int expected = regex_match(table, method, path, expected_captures);
+
+        RouteParams params;
+        int got = -1;
+        std::vector<std::string> got_captures;
+        if (const Router::Handler* handler = router.match(method, path, params)) {
+            httplib::Request req;
+            httplib::Response res;
+            (*handler)(req, res, params);
+            got = res.status;
+            for (const auto& name : ROUTES[got].params) got_captures.push_back(params[name]);
+        }
+
+        if (got != expected || got_captures != expected_captures) {
+            ++mismatches;
+            std::cout << "MISMATCH " << method << " " << path << ": router "
+                      << (got < 0 ? "404" : ROUTES[got].pattern) << ", regex "
+                      << (expected < 0 ? "404" : ROUTES[expected].pattern) << "\n";
+        }
+    }
+    std::cout << PROBES.size() - mismatches << "/" << PROBES.size() << " probes route identically\n";
+
+    std::cout << "ns per match (router vs regex table):\n";
+    for (const char* path : {"/api/status", "/api/streams/stream", "/hls/stream-123.ts", "/static/player.js"}) {
+        size_t hits = 0;
+        double trie = ns_per_call(1000000, [&] {
+            RouteParams params;
+            hits += router.match("GET", path, params) != nullptr;
+        });
+        double regex = ns_per_call(100000, [&] {
+            std::vector<std::string> captures;
+            hits += regex_match(table, "GET", path, captures) >= 0;
+        });
+        std::cout << "  " << path << ": " << trie << " vs " << regex << (hits ? "" : " (no hits)") << "\n";
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#!/bin/bash
+# Compare the httplib and epoll HTTP backends with many concurrent
+# keep-alive connections. Each connection polls /api/status like an idle
+# viewer; the script reports how many got answers, plus server threads
+# and RSS. If wrk is installed it also measures throughput.
+#
+# Usage: scripts/bench_connections.sh [binary] [connections]
+set -e
+
+BIN="${1:-./build/streaming-service}"
+CONNS="${2:-10000}"
+PORT=18085
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+ulimit -n $((CONNS + 1024))
+
+run_backend() {
+    local backend="$1"
+    cat > "$WORK_DIR/config.json" << EOF_CONFIG
+{
+    "server": { "host": "127.0.0.1", "port": $PORT, "backend": "$backend",
+                "max_connections": $((CONNS + 1000)), "idle_timeout_seconds": 120 },
+    "hls": { "path": "$WORK_DIR" },
+    "web": { "path": "./web" },
+    "thumbnails": { "enabled": false }
+}
+EOF_CONFIG
+
+    "$BIN" -c "$WORK_DIR/config.json" 2>/dev/null &
+    local pid=$!
+    sleep 1
+
+    echo "=== $backend: $CONNS keep-alive connections ==="
+    python3 - "$PORT" "$CONNS" "$pid" << 'EOF_PY'
+import socket, sys, time
+port, n, pid = int(sys.argv[1]), int(sys.argv[2]), sys.argv[3]
+req = b"GET /api/status HTTP/1.1\r\nHost: bench\r\n\r\n"
+socks = []
+for _ in range(n):
+    socks.append(socket.create_connection(("127.0.0.1", port)))
+for rnd in range(2):
+    start = time.time()
+    for s in socks:
+        s.sendall(req)
+    # One 30 s deadline per round, not per socket: a backend that queues
+    # connections would otherwise take hours to time out
+    deadline = start + 30
+    ok = 0
+    for s in socks:
+        s.settimeout(max(0.01, deadline - time.time()))
+        try:
+            ok += s.recv(4096).startswith(b"HTTP/1.1 200")
+        except OSError:
+            pass
+    print(f"round {rnd + 1}: {ok}/{n} answered in {time.time() - start:.2f}s")
+status = open(f"/proc/{pid}/status").read().splitlines()
+print("  ".join(l for l in status if l.startswith(("Threads", "VmRSS"))))
+EOF_PY
+
+    if command -v wrk > /dev/null; then
+        wrk -t4 -c"$CONNS" -d15s "http://127.0.0.1:$PORT/api/status" | grep -E "Requests/sec|Latency|errors"
+    fi
+
+    kill "$pid"
+    wait "$pid" 2>/dev/null || true
+}
+
+run_backend httplib
+run_backend epoll
@@ -45,6 +45,8 @@ Type=simple
 User=www-data
 Group=www-data
 WorkingDirectory=/var/www/streaming-service
+# /var/lib/streaming-service, owned by www-data, for state snapshots
+StateDirectory=streaming-service
 ExecStart=/var/www/streaming-service/bin/streaming-service -c /var/www/streaming-service/config.json
 Environment=PORT=8085
 Restart=always
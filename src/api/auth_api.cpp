@@ -2,15 +2,59 @@
 #include "core/auth_manager.h"
 #include "utils/logger.h"
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 using json = nlohmann::json;
 
-void AuthAPI::register_routes(httplib::Server& svr, AuthManager& mgr) {
+namespace {
+
+void bad_request(httplib::Response& res, const std::string& message) {
+    json j;
+    j["error"] = message;
+    res.status = 400;
+    res.set_content(j.dump(), "application/json");
+}
+
+// Parses a JSON object body; on failure answers 400 and returns false
+bool parse_body(const httplib::Request& req, httplib::Response& res, json& body) {
+    body = json::parse(req.body, nullptr, false);
+    if (body.is_discarded() || !body.is_object()) {
+        bad_request(res, "expected a JSON object body");
+        return false;
+    }
+    return true;
+}
+
+// Longest ttl_seconds accepted (100 years), so now + ttl cannot overflow
+constexpr int64_t kMaxTtlSeconds = 100LL * 365 * 24 * 3600;
+
+// Reads an optional integer field. A present field that is not an integer
+// (a string, a float, a bool...) is rejected rather than coerced.
+bool integer_field(const json& object, const char* name, int64_t& out) {
+    if (!object.contains(name)) return true;
+    const auto& value = object[name];
+    if (!value.is_number_integer()) return false;
+    out = value.get<int64_t>();
+    return true;
+}
+
+json key_json(const StreamKey& k) {
+    json j;
+    j["key"] = k.key;
+    if (k.expires_at != 0) j["expires_at"] = k.expires_at;
+    return j;
+}
+
+} // namespace
+
+void AuthAPI::register_routes(Router& router, AuthManager& mgr) {
 
     // POST /api/auth — nginx on_publish callback
     // nginx sends: name=<stream_name>&key=<stream_key> as form data
     // Return 200 to allow, 403 to reject
-    svr.Post("/api/auth", [&mgr](const httplib::Request& req, httplib::Response& res) {
+    router.Post("/api/auth", [&mgr](const httplib::Request& req, httplib::Response& res, const RouteParams&) {
         // nginx-rtmp sends stream info as form-encoded POST body
         std::string key;
 
@@ -35,7 +79,7 @@ void AuthAPI::register_routes(httplib::Server& svr, AuthManager& mgr) {
     });
 
     // POST /api/auth/keys — generate new key
-    svr.Post("/api/auth/keys", [&mgr](const httplib::Request&, httplib::Response& res) {
+    router.Post("/api/auth/keys", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams&) {
         std::string key = mgr.generate_key();
 
         json j;
@@ -44,20 +88,141 @@ void AuthAPI::register_routes(httplib::Server& svr, AuthManager& mgr) {
         res.set_content(j.dump(), "application/json");
     });
 
-    // GET /api/auth/keys — list all keys
-    svr.Get("/api/auth/keys", [&mgr](const httplib::Request&, httplib::Response& res) {
-        auto keys = mgr.list_keys();
+    // GET /api/auth/keys?limit=&after= — list keys, one page at a time
+    router.Get("/api/auth/keys", [&mgr](const httplib::Request& req, httplib::Response& res, const RouteParams&) {
+        size_t limit = 1000;
+        if (req.has_param("limit")) {
+            long long requested = std::atoll(req.get_param_value("limit").c_str());
+            if (requested <= 0) {
+                bad_request(res, "limit must be positive");
+                return;
+            }
+            limit = std::min<size_t>(static_cast<size_t>(requested), AuthManager::MAX_BATCH);
+        }
+
+        std::string next;
+        auto page = mgr.list_keys(req.get_param_value("after"), limit, next);
 
         json j;
-        j["keys"] = keys;
+        j["keys"] = json::array();
+        json expires = json::object();
+        for (const auto& k : page) {
+            j["keys"].push_back(k.key);
+            if (k.expires_at != 0) expires[k.key] = k.expires_at;
+        }
+        j["expires_at"] = expires;
         j["enabled"] = mgr.is_enabled();
+        j["total"] = mgr.key_count();
+        if (!next.empty()) j["next"] = next;
+
+        res.set_content(j.dump(), "application/json");
+    });
 
+    // POST /api/auth/keys/batch — generate {"count": N, "ttl_seconds": T} keys at once
+    router.Post("/api/auth/keys/batch", [&mgr](const httplib::Request& req, httplib::Response& res, const RouteParams&) {
+        json body;
+        if (!parse_body(req, res, body)) return;
+
+        int64_t count = 0;
+        int64_t ttl = 0;
+        if (!integer_field(body, "count", count) || !integer_field(body, "ttl_seconds", ttl) ||
+            count <= 0 || count > static_cast<int64_t>(AuthManager::MAX_BATCH) ||
+            ttl < 0 || ttl > kMaxTtlSeconds) {
+            bad_request(res, "count must be an integer 1-" + std::to_string(AuthManager::MAX_BATCH)
+                             + ", ttl_seconds an integer 0-" + std::to_string(kMaxTtlSeconds));
+            return;
+        }
+
+        json j;
+        j["keys"] = json::array();
+        for (const auto& k : mgr.generate_keys(static_cast<size_t>(count), ttl)) {
+            j["keys"].push_back(key_json(k));
+        }
+        res.set_content(j.dump(), "application/json");
+    });
+
+    // POST /api/auth/keys/import — {"keys": ["k", {"key": "k", "expires_at": T}], "ttl_seconds": T}
+    // Either every key is added (or has its expiry replaced) or none are.
+    router.Post("/api/auth/keys/import", [&mgr](const httplib::Request& req, httplib::Response& res, const RouteParams&) {
+        json body;
+        if (!parse_body(req, res, body)) return;
+        if (!body.contains("keys") || !body["keys"].is_array()) {
+            bad_request(res, "missing keys array");
+            return;
+        }
+
+        int64_t ttl = 0;
+        if (!integer_field(body, "ttl_seconds", ttl) || ttl < 0 || ttl > kMaxTtlSeconds) {
+            bad_request(res, "ttl_seconds must be an integer 0-" + std::to_string(kMaxTtlSeconds));
+            return;
+        }
+        long long default_expiry = ttl > 0
+            ? std::chrono::duration_cast<std::chrono::seconds>(
+                  std::chrono::system_clock::now().time_since_epoch()).count() + ttl
+            : 0;
+
+        std::vector<StreamKey> keys;
+        keys.reserve(body["keys"].size());
+        for (const auto& entry : body["keys"]) {
+            StreamKey k;
+            k.expires_at = default_expiry;
+            if (entry.is_string()) {
+                k.key = entry.get<std::string>();
+            } else if (entry.is_object() && entry.contains("key") && entry["key"].is_string()) {
+                k.key = entry["key"].get<std::string>();
+                if (!integer_field(entry, "expires_at", k.expires_at)) {
+                    bad_request(res, "expires_at must be an integer (unix seconds)");
+                    return;
+                }
+            } else {
+                bad_request(res, "keys must be strings or {key, expires_at} objects");
+                return;
+            }
+            keys.push_back(std::move(k));
+        }
+
+        std::string error;
+        if (!mgr.import_keys(keys, error)) {
+            bad_request(res, error);
+            return;
+        }
+
+        json j;
+        j["imported"] = keys.size();
+        res.set_content(j.dump(), "application/json");
+    });
+
+    // POST /api/auth/keys/revoke — {"keys": [...]}, removed together
+    router.Post("/api/auth/keys/revoke", [&mgr](const httplib::Request& req, httplib::Response& res, const RouteParams&) {
+        json body;
+        if (!parse_body(req, res, body)) return;
+        if (!body.contains("keys") || !body["keys"].is_array() ||
+            body["keys"].size() > AuthManager::MAX_BATCH) {
+            bad_request(res, "keys must be an array of at most " + std::to_string(AuthManager::MAX_BATCH));
+            return;
+        }
+
+        std::vector<std::string> keys;
+        keys.reserve(body["keys"].size());
+        for (const auto& entry : body["keys"]) {
+            if (!entry.is_string()) {
+                bad_request(res, "keys must be strings");
+                return;
+            }
+            keys.push_back(entry.get<std::string>());
+        }
+
+        auto removed = mgr.revoke_keys(keys);
+
+        json j;
+        j["revoked"] = removed;
+        j["count"] = removed.size();
         res.set_content(j.dump(), "application/json");
     });
 
     // DELETE /api/auth/keys/:key
-    svr.Delete(R"(/api/auth/keys/(\w+))", [&mgr](const httplib::Request& req, httplib::Response& res) {
-        std::string key = req.matches[1];
+    router.Delete("/api/auth/keys/:key", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams& params) {
+        std::string key = params["key"];
         bool removed = mgr.remove_key(key);
 
         json j;
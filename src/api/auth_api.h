@@ -1,6 +1,6 @@
 #pragma once
 
-#include <httplib.h>
+#include "api/router.h"
 
 class AuthManager;
 
@@ -8,6 +8,9 @@ namespace AuthAPI {
     // POST /api/auth             — validate stream key (nginx on_publish callback)
     // POST /api/auth/keys        — generate a new stream key
     // DELETE /api/auth/keys/:key — remove a stream key
-    // GET /api/auth/keys         — list stream keys (admin)
-    void register_routes(httplib::Server& svr, AuthManager& mgr);
+    // GET /api/auth/keys         — list stream keys, paginated (admin)
+    // POST /api/auth/keys/batch  — generate many keys, optionally expiring
+    // POST /api/auth/keys/import — add many keys atomically
+    // POST /api/auth/keys/revoke — remove many keys atomically
+    void register_routes(Router& router, AuthManager& mgr);
 }
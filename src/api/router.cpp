@@ -0,0 +1,165 @@
+#include "api/router.h"
+#include <stdexcept>
+
+struct Router::Node {
+    std::unordered_map<std::string, std::unique_ptr<Node>> children;
+    std::unique_ptr<Node> param;        // ":name" child
+    std::string param_name;
+    std::unique_ptr<Node> rest;         // "*name" child (always a leaf)
+    std::string rest_name;
+    Handler handlers[METHOD_COUNT];
+};
+
+namespace {
+
+bool is_word_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+} // anonymous namespace
+
+const std::string& RouteParams::operator[](const std::string& name) const {
+    for (const auto& [key, value] : values_) {
+        if (key == name) return value;
+    }
+    static const std::string empty;
+    return empty;
+}
+
+Router::Router() : root_(std::make_unique<Node>()) {}
+Router::~Router() = default;
+
+Router& Router::Get(const std::string& pattern, Handler handler)     { return add(GET, pattern, std::move(handler)); }
+Router& Router::Post(const std::string& pattern, Handler handler)    { return add(POST, pattern, std::move(handler)); }
+Router& Router::Delete(const std::string& pattern, Handler handler)  { return add(DELETE, pattern, std::move(handler)); }
+Router& Router::Options(const std::string& pattern, Handler handler) { return add(OPTIONS, pattern, std::move(handler)); }
+
+Router& Router::add(Method method, const std::string& pattern, Handler handler) {
+    if (pattern.empty() || pattern[0] != '/') {
+        throw std::invalid_argument("Route pattern must start with '/': " + pattern);
+    }
+
+    Node* node = root_.get();
+    size_t pos = 1;
+    while (true) {
+        size_t end = pattern.find('/', pos);
+        std::string segment = pattern.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+
+        if (!segment.empty() && segment[0] == '*') {
+            if (end != std::string::npos) {
+                throw std::invalid_argument("'*' must be the last segment: " + pattern);
+            }
+            if (!node->rest) node->rest = std::make_unique<Node>();
+            node->rest_name = segment.substr(1);
+            node = node->rest.get();
+            break;
+        }
+
+        if (!segment.empty() && segment[0] == ':') {
+            std::string name = segment.substr(1);
+            if (node->param && node->param_name != name) {
+                throw std::invalid_argument("Conflicting parameter names at: " + pattern);
+            }
+            if (!node->param) node->param = std::make_unique<Node>();
+            node->param_name = name;
+            node = node->param.get();
+        } else {
+            auto& child = node->children[segment];
+            if (!child) child = std::make_unique<Node>();
+            node = child.get();
+        }
+
+        if (end == std::string::npos) break;
+        pos = end + 1;
+    }
+
+    node->handlers[method] = std::move(handler);
+    return *this;
+}
+
+int Router::method_index(const std::string& method) {
+    if (method == "GET" || method == "HEAD") return GET;
+    if (method == "POST") return POST;
+    if (method == "DELETE") return DELETE;
+    if (method == "OPTIONS") return OPTIONS;
+    return -1;
+}
+
+bool Router::match_node(const Node& node, const std::string& path, size_t pos,
+                        int method, RouteParams& params, const Handler*& out) {
+    if (pos > path.size()) {
+        // Consumed the whole path on the previous segment
+        if (node.handlers[method]) {
+            out = &node.handlers[method];
+            return true;
+        }
+        return false;
+    }
+
+    size_t end = path.find('/', pos);
+    if (end == std::string::npos) end = path.size();
+    size_t next = end + 1;
+
+    if (!node.children.empty()) {
+        auto it = node.children.find(path.substr(pos, end - pos));
+        if (it != node.children.end() && match_node(*it->second, path, next, method, params, out)) {
+            return true;
+        }
+    }
+
+    if (node.param && end > pos) {
+        bool word = true;
+        for (size_t i = pos; i < end && word; ++i) word = is_word_char(path[i]);
+        if (word) {
+            params.push(node.param_name, path.substr(pos, end - pos));
+            if (match_node(*node.param, path, next, method, params, out)) return true;
+            params.pop();
+        }
+    }
+
+    if (node.rest && pos < path.size() && node.rest->handlers[method]) {
+        params.push(node.rest_name, path.substr(pos));
+        out = &node.rest->handlers[method];
+        return true;
+    }
+
+    return false;
+}
+
+const Router::Handler* Router::match(const std::string& method, const std::string& path,
+                                     RouteParams& params) const {
+    int m = method_index(method);
+    if (m < 0 || path.empty() || path[0] != '/') return nullptr;
+
+    const Handler* out = nullptr;
+    match_node(*root_, path, 1, m, params, out);
+    return out;
+}
+
+bool Router::dispatch(const httplib::Request& req, httplib::Response& res) const {
+    RouteParams params;
+    const Handler* handler = match(req.method, req.path, params);
+    if (!handler) return false;
+    (*handler)(req, res, params);
+    return true;
+}
+
+void Router::install(httplib::Server& svr) {
+    // httplib runs the pre-routing hook before it reads the request body,
+    // so only bodiless methods are dispatched from there. POST and DELETE
+    // go through catch-all handlers, which httplib calls after the body
+    // (and any form params in it) has been read.
+    svr.set_pre_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+        if (req.method != "GET" && req.method != "HEAD" && req.method != "OPTIONS") {
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
+        return dispatch(req, res) ? httplib::Server::HandlerResponse::Handled
+                                  : httplib::Server::HandlerResponse::Unhandled;
+    });
+
+    auto with_body = [this](const httplib::Request& req, httplib::Response& res) {
+        if (!dispatch(req, res)) res.status = 404;
+    };
+    svr.Post(R"(/.*)", with_body);
+    svr.Delete(R"(/.*)", with_body);
+}
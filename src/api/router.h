@@ -0,0 +1,63 @@
+#pragma once
+
+#include <httplib.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+// Path parameters captured while matching a route
+class RouteParams {
+public:
+    const std::string& operator[](const std::string& name) const;
+
+    void push(const std::string& name, std::string value) { values_.emplace_back(name, std::move(value)); }
+    void pop() { values_.pop_back(); }
+    size_t size() const { return values_.size(); }
+
+private:
+    std::vector<std::pair<std::string, std::string>> values_;
+};
+
+// Route table compiled into a prefix trie, matched one path segment at a
+// time instead of running every registered std::regex. Pattern syntax:
+//
+//   /api/streams/:name        ":name"  one segment of word characters ([A-Za-z0-9_]+)
+//   /hls/*file                "*file"  the rest of the path, non-empty, may contain '/'
+//
+// Static segments take precedence over ":params", which take precedence
+// over "*rest", so registration order does not matter.
+class Router {
+public:
+    using Handler = std::function<void(const httplib::Request&, httplib::Response&, const RouteParams&)>;
+
+    Router();
+    ~Router();
+
+    Router& Get(const std::string& pattern, Handler handler);
+    Router& Post(const std::string& pattern, Handler handler);
+    Router& Delete(const std::string& pattern, Handler handler);
+    Router& Options(const std::string& pattern, Handler handler);
+
+    // Find the handler for a request; HEAD is routed to GET handlers
+    const Handler* match(const std::string& method, const std::string& path, RouteParams& params) const;
+
+    // Run the matching handler. Returns false if no route matched.
+    bool dispatch(const httplib::Request& req, httplib::Response& res) const;
+
+    // Serve the route table from an httplib server
+    void install(httplib::Server& svr);
+
+private:
+    enum Method { GET, POST, DELETE, OPTIONS, METHOD_COUNT };
+
+    struct Node;
+
+    Router& add(Method method, const std::string& pattern, Handler handler);
+    static int method_index(const std::string& method);
+    static bool match_node(const Node& node, const std::string& path, size_t pos,
+                           int method, RouteParams& params, const Handler*& out);
+
+    std::unique_ptr<Node> root_;
+};
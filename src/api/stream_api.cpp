@@ -1,7 +1,9 @@
 #include "api/stream_api.h"
 #include "core/stream_manager.h"
+#include "core/thumbnail_pipeline.h"
 #include <nlohmann/json.hpp>
 #include <chrono>
+#include <sstream>
 
 using json = nlohmann::json;
 
@@ -29,15 +31,57 @@ json stream_to_json(const StreamInfo& info) {
         j["uptime_seconds"] = uptime_seconds(info.started_at);
     }
     j["viewers"] = info.viewer_estimate;
+    j["bytes_served"] = info.bytes_served;
+    j["playlist_requests"] = info.playlist_requests;
+    j["segment_requests"] = info.segment_requests;
     return j;
 }
 
+json clients_to_json(const std::vector<ClientUsage>& clients) {
+    json arr = json::array();
+    for (const auto& c : clients) {
+        json j;
+        j["address"] = c.address;
+        j["bytes_served"] = c.bytes_served;
+        j["last_seen"] = time_to_iso(c.last_seen);
+        arr.push_back(j);
+    }
+    return arr;
+}
+
+json health_to_json(const StreamHealth& h) {
+    json j;
+    j["score"] = h.score;
+    j["alerts"] = h.alerts;
+    j["target_duration"] = h.target_duration;
+    j["avg_segment_duration"] = h.avg_segment_duration;
+    j["max_segment_duration"] = h.max_segment_duration;
+    j["arrival_jitter"] = h.arrival_jitter;
+    j["avg_bitrate_kbps"] = h.avg_bitrate_kbps;
+    j["last_bitrate_kbps"] = h.last_bitrate_kbps;
+    j["seconds_since_segment"] = h.seconds_since_segment;
+    j["segments_observed"] = h.segments_observed;
+    j["missing_segments"] = h.missing_segments;
+    return j;
+}
+
+// Prometheus label values must escape backslash, quote and newline
+std::string label_value(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') { out += "\\n"; continue; }
+        out += c;
+    }
+    return out;
+}
+
 } // anonymous namespace
 
-void StreamAPI::register_routes(httplib::Server& svr, StreamManager& mgr) {
+void StreamAPI::register_routes(Router& router, StreamManager& mgr, ThumbnailPipeline& thumbs) {
 
     // GET /api/status — quick check
-    svr.Get("/api/status", [&mgr](const httplib::Request&, httplib::Response& res) {
+    router.Get("/api/status", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams&) {
         auto streams = mgr.get_all_streams();
         bool any_live = false;
         for (const auto& s : streams) {
@@ -53,7 +97,7 @@ void StreamAPI::register_routes(httplib::Server& svr, StreamManager& mgr) {
     });
 
     // GET /api/streams — list all
-    svr.Get("/api/streams", [&mgr](const httplib::Request&, httplib::Response& res) {
+    router.Get("/api/streams", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams&) {
         auto streams = mgr.get_all_streams();
         json arr = json::array();
         for (const auto& s : streams) {
@@ -68,17 +112,97 @@ void StreamAPI::register_routes(httplib::Server& svr, StreamManager& mgr) {
     });
 
     // GET /api/streams/:name
-    svr.Get(R"(/api/streams/(\w+))", [&mgr](const httplib::Request& req, httplib::Response& res) {
-        std::string name = req.matches[1];
+    router.Get("/api/streams/:name", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams& params) {
+        std::string name = params["name"];
         auto info = mgr.get_stream(name);
 
+        json j = stream_to_json(info);
+        j["clients"] = clients_to_json(mgr.get_client_usage(name));
+        j["health"] = health_to_json(mgr.get_health(name));
+
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_content(j.dump(), "application/json");
+    });
+
+    // GET /api/streams/:name/thumbnail
+    router.Get("/api/streams/:name/thumbnail", [&thumbs](const httplib::Request&, httplib::Response& res, const RouteParams& params) {
+        auto preview = thumbs.get(params["name"]);
+        res.set_header("Access-Control-Allow-Origin", "*");
+        if (!preview.thumbnail) {
+            res.status = 404;
+            return;
+        }
+        res.set_header("Cache-Control", "max-age=5");
+        res.set_content(*preview.thumbnail, "image/jpeg");
+    });
+
+    // GET /api/streams/:name/sprite
+    router.Get("/api/streams/:name/sprite", [&thumbs](const httplib::Request&, httplib::Response& res, const RouteParams& params) {
+        auto preview = thumbs.get(params["name"]);
         res.set_header("Access-Control-Allow-Origin", "*");
-        res.set_content(stream_to_json(info).dump(), "application/json");
+        if (!preview.sprite) {
+            res.status = 404;
+            return;
+        }
+        res.set_header("Cache-Control", "max-age=5");
+        res.set_header("X-Sprite-Columns", std::to_string(preview.sprite_columns));
+        res.set_header("X-Sprite-Frames", std::to_string(preview.sprite_frames));
+        res.set_content(*preview.sprite, "image/jpeg");
+    });
+
+    // GET /api/metrics — Prometheus text exposition
+    router.Get("/api/metrics", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams&) {
+        auto streams = mgr.get_all_streams();
+        std::ostringstream out;
+
+        out << "# TYPE streaming_bytes_served_total counter\n";
+        out << "streaming_bytes_served_total " << mgr.total_bytes_served() << "\n";
+
+        out << "# TYPE streaming_stream_bytes_served_total counter\n";
+        for (const auto& s : streams) {
+            out << "streaming_stream_bytes_served_total{stream=\"" << label_value(s.name) << "\"} "
+                << s.bytes_served << "\n";
+        }
+        out << "# TYPE streaming_stream_requests_total counter\n";
+        for (const auto& s : streams) {
+            out << "streaming_stream_requests_total{stream=\"" << label_value(s.name) << "\",kind=\"playlist\"} "
+                << s.playlist_requests << "\n";
+            out << "streaming_stream_requests_total{stream=\"" << label_value(s.name) << "\",kind=\"segment\"} "
+                << s.segment_requests << "\n";
+        }
+        out << "# TYPE streaming_stream_clients gauge\n";
+        for (const auto& s : streams) {
+            out << "streaming_stream_clients{stream=\"" << label_value(s.name) << "\"} "
+                << mgr.get_client_usage(s.name).size() << "\n";
+        }
+        out << "# TYPE streaming_stream_live gauge\n";
+        for (const auto& s : streams) {
+            out << "streaming_stream_live{stream=\"" << label_value(s.name) << "\"} "
+                << (s.live ? 1 : 0) << "\n";
+        }
+        // Only streams the health monitor has seen segments for
+        std::vector<std::pair<std::string, StreamHealth>> health;
+        for (const auto& s : streams) {
+            auto h = mgr.get_health(s.name);
+            if (h.segments_observed > 0) health.emplace_back(s.name, std::move(h));
+        }
+        out << "# TYPE streaming_stream_health_score gauge\n";
+        for (const auto& [name, h] : health) {
+            out << "streaming_stream_health_score{stream=\"" << label_value(name) << "\"} "
+                << h.score << "\n";
+        }
+        out << "# TYPE streaming_stream_missing_segments_total counter\n";
+        for (const auto& [name, h] : health) {
+            out << "streaming_stream_missing_segments_total{stream=\"" << label_value(name) << "\"} "
+                << h.missing_segments << "\n";
+        }
+
+        res.set_content(out.str(), "text/plain; version=0.0.4");
     });
 
     // POST /api/streams/:name/publish — called by nginx on_publish
-    svr.Post(R"(/api/streams/(\w+)/publish)", [&mgr](const httplib::Request& req, httplib::Response& res) {
-        std::string name = req.matches[1];
+    router.Post("/api/streams/:name/publish", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams& params) {
+        std::string name = params["name"];
         mgr.on_publish(name);
 
         json j;
@@ -89,8 +213,8 @@ void StreamAPI::register_routes(httplib::Server& svr, StreamManager& mgr) {
     });
 
     // POST /api/streams/:name/publish_done — called by nginx on_publish_done
-    svr.Post(R"(/api/streams/(\w+)/publish_done)", [&mgr](const httplib::Request& req, httplib::Response& res) {
-        std::string name = req.matches[1];
+    router.Post("/api/streams/:name/publish_done", [&mgr](const httplib::Request&, httplib::Response& res, const RouteParams& params) {
+        std::string name = params["name"];
         mgr.on_publish_done(name);
 
         json j;
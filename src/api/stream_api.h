@@ -1,12 +1,16 @@
 #pragma once
 
-#include <httplib.h>
+#include "api/router.h"
 
 class StreamManager;
+class ThumbnailPipeline;
 
 namespace StreamAPI {
     // GET /api/streams          — list all streams
-    // GET /api/streams/:name    — get stream info
+    // GET /api/streams/:name    — get stream info, including per-client egress
     // GET /api/status           — quick status check (is any stream live?)
-    void register_routes(httplib::Server& svr, StreamManager& mgr);
+    // GET /api/streams/:name/thumbnail — latest preview JPEG
+    // GET /api/streams/:name/sprite    — JPEG sprite sheet of recent previews
+    // GET /api/metrics          — Prometheus metrics (bytes served, requests, clients)
+    void register_routes(Router& router, StreamManager& mgr, ThumbnailPipeline& thumbs);
 }
@@ -0,0 +1,177 @@
+#include "core/asset_cache.h"
+#include "utils/hash.h"
+#include "utils/logger.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef STREAMING_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+#ifdef STREAMING_BROTLI_SUPPORT
+#include <brotli/encode.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string mime_type(const std::string& ext) {
+    if (ext == ".html") return "text/html; charset=utf-8";
+    if (ext == ".css")  return "text/css; charset=utf-8";
+    if (ext == ".js")   return "application/javascript; charset=utf-8";
+    if (ext == ".json") return "application/json";
+    if (ext == ".svg")  return "image/svg+xml";
+    if (ext == ".png")  return "image/png";
+    if (ext == ".jpg" || ext == ".jpeg") return "image/jpeg";
+    if (ext == ".ico")  return "image/x-icon";
+    if (ext == ".woff2") return "font/woff2";
+    return "application/octet-stream";
+}
+
+bool is_compressible(const std::string& ext) {
+    return ext == ".html" || ext == ".css" || ext == ".js" || ext == ".json" || ext == ".svg";
+}
+
+std::string gzip_compress(const std::string& in) {
+#ifdef STREAMING_ZLIB_SUPPORT
+    z_stream zs{};
+    // 15 window bits + 16 selects the gzip wrapper
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    std::string out(deflateBound(&zs, in.size()), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    int rc = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return rc == Z_STREAM_END ? out : std::string();
+#else
+    (void)in;
+    return {};
+#endif
+}
+
+std::string brotli_compress(const std::string& in) {
+#ifdef STREAMING_BROTLI_SUPPORT
+    size_t out_size = BrotliEncoderMaxCompressedSize(in.size());
+    std::string out(out_size, '\0');
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               in.size(), reinterpret_cast<const uint8_t*>(in.data()),
+                               &out_size, reinterpret_cast<uint8_t*>(out.data()))) {
+        return {};
+    }
+    out.resize(out_size);
+    return out;
+#else
+    (void)in;
+    return {};
+#endif
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return {(std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()};
+}
+
+void replace_all(std::string& s, const std::string& from, const std::string& to) {
+    for (size_t pos = s.find(from); pos != std::string::npos; pos = s.find(from, pos + to.size())) {
+        s.replace(pos, from.size(), to);
+    }
+}
+
+std::shared_ptr<WebAsset> make_asset(const std::string& rel, std::string body) {
+    auto asset = std::make_shared<WebAsset>();
+    fs::path p(rel);
+    std::string ext = p.extension().string();
+
+    asset->path = rel;
+    asset->content_type = mime_type(ext);
+    asset->hash = hash_to_hex(fnv1a_64(body));
+    asset->fingerprinted = (p.parent_path() / (p.stem().string() + "." + asset->hash.substr(0, 8) + ext))
+                               .generic_string();
+
+    if (is_compressible(ext)) {
+        // Keep a variant only when it actually saves bytes
+        asset->gzip = gzip_compress(body);
+        if (asset->gzip.size() >= body.size()) asset->gzip.clear();
+        asset->brotli = brotli_compress(body);
+        if (asset->brotli.size() >= body.size()) asset->brotli.clear();
+    }
+    asset->body = std::move(body);
+    return asset;
+}
+
+} // anonymous namespace
+
+AssetCache::AssetCache(const std::string& web_path)
+    : web_path_(web_path)
+    , by_path_(std::make_shared<AssetMap>())
+    , by_fingerprint_(std::make_shared<AssetMap>()) {
+}
+
+void AssetCache::reload() {
+    auto by_path = std::make_shared<AssetMap>();
+    auto by_fingerprint = std::make_shared<AssetMap>();
+
+    std::error_code ec;
+    if (!fs::is_directory(web_path_, ec)) {
+        Logger::warn("Web path does not exist: " + web_path_);
+    } else {
+        std::vector<std::pair<std::string, std::string>> html;
+
+        for (const auto& entry : fs::recursive_directory_iterator(web_path_, ec)) {
+            if (!entry.is_regular_file()) continue;
+            std::string rel = fs::relative(entry.path(), web_path_).generic_string();
+            std::string body = read_file(entry.path());
+
+            // HTML references other assets, so fingerprint those first
+            if (entry.path().extension() == ".html") {
+                html.emplace_back(rel, std::move(body));
+                continue;
+            }
+            auto asset = make_asset(rel, std::move(body));
+            (*by_fingerprint)[asset->fingerprinted] = asset;
+            (*by_path)[rel] = std::move(asset);
+        }
+
+        for (auto& [rel, body] : html) {
+            for (const auto& [path, asset] : *by_path) {
+                replace_all(body, "\"/static/" + path + "\"", "\"/static/" + asset->fingerprinted + "\"");
+            }
+            auto asset = make_asset(rel, std::move(body));
+            (*by_fingerprint)[asset->fingerprinted] = asset;
+            (*by_path)[rel] = std::move(asset);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        by_path_ = std::move(by_path);
+        by_fingerprint_ = std::move(by_fingerprint);
+    }
+    Logger::info("Web assets loaded from " + web_path_);
+}
+
+std::shared_ptr<const WebAsset> AssetCache::find(const std::string& path, bool* immutable) const {
+    std::shared_ptr<const AssetMap> by_path, by_fingerprint;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        by_path = by_path_;
+        by_fingerprint = by_fingerprint_;
+    }
+
+    if (immutable) *immutable = false;
+    auto it = by_path->find(path);
+    if (it != by_path->end()) return it->second;
+
+    it = by_fingerprint->find(path);
+    if (it != by_fingerprint->end()) {
+        if (immutable) *immutable = true;
+        return it->second;
+    }
+    return nullptr;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct WebAsset {
+    std::string path;           // relative to the web directory, e.g. "player.js"
+    std::string fingerprinted;  // e.g. "player.3f9a1c2e.js"
+    std::string content_type;
+    std::string hash;           // hex content hash
+    std::string body;
+    std::string gzip;           // empty if not compressible or no zlib
+    std::string brotli;         // empty if not compressible or no brotli
+};
+
+// In-memory copy of the web player directory. Assets are precompressed at
+// load time and index.html is rewritten to reference fingerprinted
+// /static/ URLs so those can be cached indefinitely.
+class AssetCache {
+public:
+    explicit AssetCache(const std::string& web_path);
+
+    // (Re)load every file in the web directory; safe to call while serving
+    void reload();
+
+    // Look up by relative path or fingerprinted name. `immutable` is set when
+    // the fingerprinted name was used.
+    std::shared_ptr<const WebAsset> find(const std::string& path, bool* immutable = nullptr) const;
+
+    const std::string& web_path() const { return web_path_; }
+
+private:
+    using AssetMap = std::unordered_map<std::string, std::shared_ptr<const WebAsset>>;
+
+    std::string web_path_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const AssetMap> by_path_;
+    std::shared_ptr<const AssetMap> by_fingerprint_;
+};
@@ -1,49 +1,240 @@
 #include "core/auth_manager.h"
 #include "utils/logger.h"
-#include <random>
-#include <sstream>
-#include <iomanip>
+#include <sys/random.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+int64_t now_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Kernel CSPRNG output, buffered per thread so a batch of keys costs a
+// handful of getrandom() calls instead of one per key.
+class RandomPool {
+public:
+    void fill(unsigned char* out, size_t size) {
+        while (size > 0) {
+            if (pos_ == sizeof(buf_)) refill();
+            size_t n = std::min(size, sizeof(buf_) - pos_);
+            std::memcpy(out, buf_ + pos_, n);
+            std::memset(buf_ + pos_, 0, n);
+            pos_ += n;
+            out += n;
+            size -= n;
+        }
+    }
+
+private:
+    void refill() {
+        size_t got = 0;
+        while (got < sizeof(buf_)) {
+            ssize_t n = getrandom(buf_ + got, sizeof(buf_) - got, 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("getrandom failed: ") + std::strerror(errno));
+            }
+            got += static_cast<size_t>(n);
+        }
+        pos_ = 0;
+    }
+
+    unsigned char buf_[512];
+    size_t pos_ = sizeof(buf_);
+};
+
+std::string random_hex_key() {
+    // Random 32-character hex key
+    thread_local RandomPool pool;
+    unsigned char bytes[16];
+    pool.fill(bytes, sizeof(bytes));
+
+    static const char digits[] = "0123456789abcdef";
+    std::string key(32, '0');
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        key[2 * i] = digits[bytes[i] >> 4];
+        key[2 * i + 1] = digits[bytes[i] & 0x0f];
+    }
+    return key;
+}
+
+} // namespace
 
 AuthManager::AuthManager(const std::vector<std::string>& keys, bool enabled)
-    : enabled_(enabled), keys_(keys.begin(), keys.end()) {
+    : enabled_(enabled) {
+    for (const auto& key : keys) keys_.emplace(key, 0);
     Logger::info("Auth manager initialized with " + std::to_string(keys_.size()) + " keys, enabled=" + (enabled_ ? "true" : "false"));
 }
 
-bool AuthManager::validate(const std::string& key) const {
+bool AuthManager::valid_key(const std::string& key) {
+    if (key.empty() || key.size() > 128) return false;
+    for (char c : key) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '_';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool AuthManager::validate(const std::string& key) {
     if (!enabled_) return true;
 
     std::lock_guard<std::mutex> lock(mutex_);
+    reclaim_expired(now_seconds());
     return keys_.count(key) > 0;
 }
 
 std::string AuthManager::generate_key() {
-    // Generate a random 32-character hex key
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 255);
-
-    std::ostringstream oss;
-    for (int i = 0; i < 16; ++i) {
-        oss << std::hex << std::setfill('0') << std::setw(2) << dis(gen);
+    std::string key;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        key = unique_key();
+        set_key(key, 0);
     }
-
-    std::string key = oss.str();
-    add_key(key);
+    Logger::info("Stream key added");
     return key;
 }
 
 void AuthManager::add_key(const std::string& key) {
     std::lock_guard<std::mutex> lock(mutex_);
-    keys_.insert(key);
+    set_key(key, 0);
     Logger::info("Stream key added");
 }
 
 bool AuthManager::remove_key(const std::string& key) {
     std::lock_guard<std::mutex> lock(mutex_);
-    return keys_.erase(key) > 0;
+    return erase_key(key);
+}
+
+std::vector<StreamKey> AuthManager::generate_keys(size_t count, int64_t ttl_seconds) {
+    std::vector<StreamKey> created;
+    if (count == 0 || count > MAX_BATCH) return created;
+    created.reserve(count);
+
+    // Draw the keys before taking the lock so validate() is not held up by
+    // a large batch; the lock only covers the inserts
+    int64_t now = now_seconds();
+    int64_t expires_at = ttl_seconds > 0 ? now + ttl_seconds : 0;
+    for (size_t i = 0; i < count; ++i) {
+        created.push_back({random_hex_key(), expires_at});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reclaim_expired(now);
+        for (auto& k : created) {
+            // A 128-bit collision with an existing key is not expected,
+            // but never let one overwrite another key's expiry
+            if (keys_.count(k.key)) k.key = unique_key();
+            set_key(k.key, k.expires_at);
+        }
+    }
+    Logger::info("Generated " + std::to_string(count) + " stream keys");
+    return created;
+}
+
+bool AuthManager::import_keys(const std::vector<StreamKey>& keys, std::string& error) {
+    if (keys.empty() || keys.size() > MAX_BATCH) {
+        error = "batch must contain 1-" + std::to_string(MAX_BATCH) + " keys";
+        return false;
+    }
+
+    int64_t now = now_seconds();
+    for (const auto& k : keys) {
+        if (!valid_key(k.key)) {
+            error = "invalid key: " + k.key.substr(0, 128);
+            return false;
+        }
+        if (k.expires_at != 0 && k.expires_at <= now) {
+            error = "key already expired: " + k.key;
+            return false;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reclaim_expired(now);
+        for (const auto& k : keys) set_key(k.key, k.expires_at);
+    }
+    Logger::info("Imported " + std::to_string(keys.size()) + " stream keys");
+    return true;
+}
+
+std::vector<std::string> AuthManager::revoke_keys(const std::vector<std::string>& keys) {
+    std::vector<std::string> removed;
+    if (keys.size() > MAX_BATCH) return removed;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reclaim_expired(now_seconds());
+        for (const auto& key : keys) {
+            if (erase_key(key)) removed.push_back(key);
+        }
+    }
+    Logger::info("Revoked " + std::to_string(removed.size()) + " stream keys");
+    return removed;
+}
+
+std::vector<StreamKey> AuthManager::list_keys(const std::string& after, size_t limit, std::string& next) {
+    std::vector<StreamKey> page;
+    next.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    reclaim_expired(now_seconds());
+    auto it = after.empty() ? keys_.begin() : keys_.upper_bound(after);
+    for (; it != keys_.end() && page.size() < limit; ++it) {
+        page.push_back({it->first, it->second});
+    }
+    if (it != keys_.end() && !page.empty()) next = page.back().key;
+    return page;
 }
 
-std::vector<std::string> AuthManager::list_keys() const {
+size_t AuthManager::key_count() {
     std::lock_guard<std::mutex> lock(mutex_);
-    return {keys_.begin(), keys_.end()};
+    reclaim_expired(now_seconds());
+    return keys_.size();
+}
+
+std::string AuthManager::unique_key() const {
+    std::string key;
+    do {
+        key = random_hex_key();
+    } while (keys_.count(key));
+    return key;
+}
+
+void AuthManager::set_key(const std::string& key, int64_t expires_at) {
+    auto [it, inserted] = keys_.emplace(key, expires_at);
+    if (!inserted) {
+        if (it->second != 0) expiry_.erase({it->second, key});
+        it->second = expires_at;
+    }
+    if (expires_at != 0) expiry_.emplace(expires_at, key);
+}
+
+bool AuthManager::erase_key(const std::string& key) {
+    auto it = keys_.find(key);
+    if (it == keys_.end()) return false;
+    if (it->second != 0) expiry_.erase({it->second, key});
+    keys_.erase(it);
+    return true;
+}
+
+void AuthManager::reclaim_expired(int64_t now) {
+    // Expired keys are dropped the next time anyone touches the table; the
+    // index keeps this to the keys that actually expired.
+    size_t reclaimed = 0;
+    while (!expiry_.empty() && expiry_.begin()->first <= now) {
+        keys_.erase(expiry_.begin()->second);
+        expiry_.erase(expiry_.begin());
+        ++reclaimed;
+    }
+    if (reclaimed > 0) {
+        Logger::info("Reclaimed " + std::to_string(reclaimed) + " expired stream keys");
+    }
 }
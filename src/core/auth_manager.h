@@ -1,27 +1,58 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <set>
+#include <map>
 #include <mutex>
 #include <vector>
 
+struct StreamKey {
+    std::string key;
+    int64_t expires_at = 0;  // unix seconds, 0 = never
+};
+
 class AuthManager {
 public:
+    // Upper bound on keys created, imported or revoked by one batch call
+    static constexpr size_t MAX_BATCH = 10000;
+
     explicit AuthManager(const std::vector<std::string>& keys, bool enabled = true);
 
-    // Validate a stream key
-    bool validate(const std::string& key) const;
+    // Validate a stream key (expired keys fail and are reclaimed)
+    bool validate(const std::string& key);
 
     // Key management
     std::string generate_key();
     void add_key(const std::string& key);
     bool remove_key(const std::string& key);
-    std::vector<std::string> list_keys() const;
+
+    // Batch operations. Each one takes the lock once and applies all of its
+    // entries or none of them.
+    std::vector<StreamKey> generate_keys(size_t count, int64_t ttl_seconds);
+    bool import_keys(const std::vector<StreamKey>& keys, std::string& error);
+    std::vector<std::string> revoke_keys(const std::vector<std::string>& keys);  // returns the keys removed
+
+    // Keys ordered by value, starting after `after`. `next` is set to the
+    // cursor for the following page, or cleared on the last one.
+    std::vector<StreamKey> list_keys(const std::string& after, size_t limit, std::string& next);
+    size_t key_count();
 
     bool is_enabled() const { return enabled_; }
 
+    // Keys end up in RTMP and HLS URLs and must match the ":key" route
+    // segment of DELETE /api/auth/keys/:key, so only [A-Za-z0-9_] is accepted
+    static bool valid_key(const std::string& key);
+
 private:
+    // Callers hold mutex_
+    std::string unique_key() const;
+    void set_key(const std::string& key, int64_t expires_at);
+    bool erase_key(const std::string& key);
+    void reclaim_expired(int64_t now);
+
     bool enabled_;
-    mutable std::mutex mutex_;
-    std::set<std::string> keys_;
+    std::mutex mutex_;
+    std::map<std::string, int64_t> keys_;              // key -> expires_at
+    std::set<std::pair<int64_t, std::string>> expiry_;  // expiring keys by deadline
 };
@@ -23,11 +23,16 @@ AppConfig AppConfig::load(const std::string& path) {
         auto& s = j["server"];
         if (s.contains("host")) config.server.host = s["host"].get<std::string>();
         if (s.contains("port")) config.server.port = s["port"].get<int>();
+        if (s.contains("backend")) config.server.backend = s["backend"].get<std::string>();
+        if (s.contains("worker_threads")) config.server.worker_threads = s["worker_threads"].get<int>();
+        if (s.contains("max_connections")) config.server.max_connections = s["max_connections"].get<int>();
+        if (s.contains("idle_timeout_seconds")) config.server.idle_timeout_seconds = s["idle_timeout_seconds"].get<int>();
     }
 
     if (j.contains("hls")) {
         auto& h = j["hls"];
         if (h.contains("path")) config.hls.path = h["path"].get<std::string>();
+        if (h.contains("segment_hold_ms")) config.hls.segment_hold_ms = h["segment_hold_ms"].get<int>();
     }
 
     if (j.contains("web")) {
@@ -49,6 +54,50 @@ AppConfig AppConfig::load(const std::string& path) {
         if (r.contains("application")) config.rtmp.application = r["application"].get<std::string>();
     }
 
+    if (j.contains("egress")) {
+        auto& e = j["egress"];
+        if (e.contains("stream_rate_kbps")) config.egress.stream_rate_kbps = e["stream_rate_kbps"].get<int64_t>();
+        if (e.contains("global_rate_kbps")) config.egress.global_rate_kbps = e["global_rate_kbps"].get<int64_t>();
+        if (e.contains("max_paced_transfers")) config.egress.max_paced_transfers = e["max_paced_transfers"].get<int>();
+    }
+
+    if (j.contains("thumbnails")) {
+        auto& t = j["thumbnails"];
+        if (t.contains("enabled")) config.thumbnails.enabled = t["enabled"].get<bool>();
+        if (t.contains("ffmpeg")) config.thumbnails.ffmpeg = t["ffmpeg"].get<std::string>();
+        if (t.contains("interval_seconds")) config.thumbnails.interval_seconds = t["interval_seconds"].get<int>();
+        if (t.contains("workers")) config.thumbnails.workers = t["workers"].get<int>();
+        if (t.contains("width")) config.thumbnails.width = t["width"].get<int>();
+        if (t.contains("sprite_frames")) config.thumbnails.sprite_frames = t["sprite_frames"].get<int>();
+    }
+
+    if (j.contains("low_latency")) {
+        auto& l = j["low_latency"];
+        if (l.contains("enabled")) config.low_latency.enabled = l["enabled"].get<bool>();
+        if (l.contains("ffmpeg")) config.low_latency.ffmpeg = l["ffmpeg"].get<std::string>();
+        if (l.contains("part_target_ms")) config.low_latency.part_target_ms = l["part_target_ms"].get<int>();
+        if (l.contains("segment_target_ms")) config.low_latency.segment_target_ms = l["segment_target_ms"].get<int>();
+        if (l.contains("segments")) config.low_latency.segments = l["segments"].get<int>();
+        if (l.contains("max_blocking_requests")) config.low_latency.max_blocking_requests = l["max_blocking_requests"].get<int>();
+    }
+
+    if (j.contains("state")) {
+        auto& st = j["state"];
+        if (st.contains("snapshot_path")) config.state.snapshot_path = st["snapshot_path"].get<std::string>();
+        if (st.contains("snapshot_interval_seconds")) config.state.snapshot_interval_seconds = st["snapshot_interval_seconds"].get<int>();
+    }
+
+    // The epoll backend runs handlers on a fixed worker pool, so features
+    // whose handlers wait (LL-HLS blocking reloads, paced egress) would
+    // starve it
+    if (config.server.backend != "httplib" && config.server.backend != "epoll") {
+        throw std::runtime_error("server.backend must be \"httplib\" or \"epoll\"");
+    }
+    if (config.server.backend == "epoll"
+        && (config.low_latency.enabled || config.egress.stream_rate_kbps > 0 || config.egress.global_rate_kbps > 0)) {
+        throw std::runtime_error("server.backend \"epoll\" cannot be combined with low_latency or egress caps");
+    }
+
     Logger::info("Config loaded from " + path);
     return config;
 }
@@ -57,12 +106,34 @@ void AppConfig::save(const std::string& path) const {
     nlohmann::json j;
     j["server"]["host"] = server.host;
     j["server"]["port"] = server.port;
+    j["server"]["backend"] = server.backend;
+    j["server"]["worker_threads"] = server.worker_threads;
+    j["server"]["max_connections"] = server.max_connections;
+    j["server"]["idle_timeout_seconds"] = server.idle_timeout_seconds;
     j["hls"]["path"] = hls.path;
+    j["hls"]["segment_hold_ms"] = hls.segment_hold_ms;
     j["web"]["path"] = web.path;
     j["auth"]["enabled"] = auth.enabled;
     j["auth"]["stream_keys"] = auth.stream_keys;
     j["rtmp"]["port"] = rtmp.port;
     j["rtmp"]["application"] = rtmp.application;
+    j["egress"]["stream_rate_kbps"] = egress.stream_rate_kbps;
+    j["egress"]["global_rate_kbps"] = egress.global_rate_kbps;
+    j["egress"]["max_paced_transfers"] = egress.max_paced_transfers;
+    j["thumbnails"]["enabled"] = thumbnails.enabled;
+    j["thumbnails"]["ffmpeg"] = thumbnails.ffmpeg;
+    j["thumbnails"]["interval_seconds"] = thumbnails.interval_seconds;
+    j["thumbnails"]["workers"] = thumbnails.workers;
+    j["thumbnails"]["width"] = thumbnails.width;
+    j["thumbnails"]["sprite_frames"] = thumbnails.sprite_frames;
+    j["low_latency"]["enabled"] = low_latency.enabled;
+    j["low_latency"]["ffmpeg"] = low_latency.ffmpeg;
+    j["low_latency"]["part_target_ms"] = low_latency.part_target_ms;
+    j["low_latency"]["segment_target_ms"] = low_latency.segment_target_ms;
+    j["low_latency"]["segments"] = low_latency.segments;
+    j["low_latency"]["max_blocking_requests"] = low_latency.max_blocking_requests;
+    j["state"]["snapshot_path"] = state.snapshot_path;
+    j["state"]["snapshot_interval_seconds"] = state.snapshot_interval_seconds;
 
     std::ofstream file(path);
     if (!file.is_open()) {
@@ -2,15 +2,22 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 struct ServerConfig {
     std::string host = "0.0.0.0";
     int port = 8080;
+    // "httplib" (connections on a fixed thread pool) or "epoll" (event loop + worker pool)
+    std::string backend = "httplib";
+    int worker_threads = 16;
+    int max_connections = 20000;
+    int idle_timeout_seconds = 60;
 };
 
 struct HlsConfig {
     std::string path = "/var/www/hls";
+    int segment_hold_ms = 500;  // wait this long for a segment still being written
 };
 
 struct WebConfig {
@@ -27,12 +34,46 @@ struct RtmpConfig {
     std::string application = "live";
 };
 
+struct EgressConfig {
+    // Caps in kilobits per second; 0 means unlimited
+    int64_t stream_rate_kbps = 0;
+    int64_t global_rate_kbps = 0;
+    int max_paced_transfers = 4;    // segment downloads paced (holding a worker) at once
+};
+
+struct ThumbnailConfig {
+    bool enabled = true;
+    std::string ffmpeg = "ffmpeg";
+    int interval_seconds = 10;
+    int workers = 1;
+    int width = 320;
+    int sprite_frames = 10;
+};
+
+struct LowLatencyConfig {
+    bool enabled = false;
+    std::string ffmpeg = "ffmpeg";
+    int part_target_ms = 333;
+    int segment_target_ms = 1000;   // segments are cut at the first keyframe after this
+    int segments = 6;               // complete segments kept in the playlist
+    int max_blocking_requests = 16; // blocking reloads / preload-hint parts held at once
+};
+
+struct StateConfig {
+    std::string snapshot_path = "/var/lib/streaming-service/state.bin";  // empty = disabled
+    int snapshot_interval_seconds = 30;
+};
+
 struct AppConfig {
     ServerConfig server;
     HlsConfig hls;
     WebConfig web;
     AuthConfig auth;
     RtmpConfig rtmp;
+    EgressConfig egress;
+    ThumbnailConfig thumbnails;
+    LowLatencyConfig low_latency;
+    StateConfig state;
 
     static AppConfig load(const std::string& path);
     void save(const std::string& path) const;
@@ -0,0 +1,120 @@
+#include "core/egress_shaper.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Each bucket holds at most a quarter second of traffic, so a segment
+// goes out as a steady stream of small writes rather than one burst.
+constexpr double kBurstSeconds = 0.25;
+constexpr size_t kMinBurst = 16 * 1024;
+// Buckets of streams that sent nothing for this long are dropped
+constexpr auto kIdleBucket = std::chrono::seconds(60);
+
+} // anonymous namespace
+
+EgressShaper::EgressShaper(int64_t stream_rate, int64_t global_rate, int max_paced)
+    : stream_rate_(stream_rate), global_rate_(global_rate), max_paced_(std::max(1, max_paced)) {
+    global_.last = last_prune_ = Clock::now();
+    global_.tokens = global_rate_ * kBurstSeconds;
+    if (enabled()) {
+        Logger::info("Egress shaping enabled: per-stream " + std::to_string(stream_rate_)
+                     + " B/s, global " + std::to_string(global_rate_) + " B/s, "
+                     + std::to_string(max_paced_) + " paced transfers");
+    }
+}
+
+size_t EgressShaper::burst_size() const {
+    int64_t rate = 0;
+    if (stream_rate_ > 0) rate = stream_rate_;
+    if (global_rate_ > 0) rate = rate > 0 ? std::min(rate, global_rate_) : global_rate_;
+    return std::max(kMinBurst, static_cast<size_t>(rate * kBurstSeconds));
+}
+
+void EgressShaper::refill(Bucket& bucket, int64_t rate, Clock::time_point now) const {
+    double elapsed = std::chrono::duration<double>(now - bucket.last).count();
+    double cap = std::max(static_cast<double>(kMinBurst), rate * kBurstSeconds);
+    bucket.tokens = std::min(cap, bucket.tokens + elapsed * rate);
+    bucket.last = now;
+}
+
+EgressShaper::Bucket& EgressShaper::stream_bucket(const std::string& stream_name, Clock::time_point now) {
+    auto [it, inserted] = streams_.try_emplace(stream_name);
+    if (inserted) {
+        it->second.last = now;
+        it->second.tokens = stream_rate_ * kBurstSeconds;
+    }
+    refill(it->second, stream_rate_, now);
+    return it->second;
+}
+
+void EgressShaper::prune_idle(Clock::time_point now) {
+    if (now - last_prune_ < kIdleBucket) return;
+    last_prune_ = now;
+    for (auto it = streams_.begin(); it != streams_.end();) {
+        if (now - it->second.last > kIdleBucket) it = streams_.erase(it);
+        else ++it;
+    }
+}
+
+size_t EgressShaper::acquire(const std::string& stream_name, size_t bytes) {
+    if (!enabled() || bytes == 0) return bytes;
+
+    size_t granted = std::min(bytes, burst_size());
+
+    while (true) {
+        double wait_seconds = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto now = Clock::now();
+            prune_idle(now);
+
+            Bucket* stream = nullptr;
+            if (stream_rate_ > 0) {
+                stream = &stream_bucket(stream_name, now);
+                if (stream->tokens < granted) {
+                    wait_seconds = (granted - stream->tokens) / stream_rate_;
+                }
+            }
+            if (global_rate_ > 0) {
+                refill(global_, global_rate_, now);
+                if (global_.tokens < granted) {
+                    wait_seconds = std::max(wait_seconds, (granted - global_.tokens) / global_rate_);
+                }
+            }
+
+            if (wait_seconds <= 0) {
+                if (stream) stream->tokens -= granted;
+                if (global_rate_ > 0) global_.tokens -= granted;
+                return granted;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(wait_seconds));
+    }
+}
+
+bool EgressShaper::begin_paced() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (paced_ >= max_paced_) return false;
+    ++paced_;
+    return true;
+}
+
+void EgressShaper::end_paced() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --paced_;
+}
+
+void EgressShaper::charge(const std::string& stream_name, size_t bytes) {
+    if (!enabled() || bytes == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    prune_idle(now);
+    if (stream_rate_ > 0) stream_bucket(stream_name, now).tokens -= bytes;
+    if (global_rate_ > 0) {
+        refill(global_, global_rate_, now);
+        global_.tokens -= bytes;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+// Token-bucket pacer for HLS egress. Rates are in bytes per second;
+// a rate of 0 disables that cap.
+//
+// Pacing sleeps in the calling (HTTP worker) thread, so only
+// `max_paced` transfers may pace at once. Others are sent straight away
+// and charged to the buckets, which the paced transfers then pay back.
+class EgressShaper {
+public:
+    EgressShaper(int64_t stream_rate, int64_t global_rate, int max_paced);
+
+    bool enabled() const { return stream_rate_ > 0 || global_rate_ > 0; }
+
+    // Block until up to `bytes` may be sent for the given stream.
+    // Returns the number of bytes granted (never more than one burst).
+    size_t acquire(const std::string& stream_name, size_t bytes);
+
+    // Claim one of the paced transfer slots; false when all are taken.
+    // Every successful begin_paced() must be matched by end_paced().
+    bool begin_paced();
+    void end_paced();
+
+    // Account bytes sent without pacing; the buckets may go into debt
+    void charge(const std::string& stream_name, size_t bytes);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Bucket {
+        double tokens = 0;
+        Clock::time_point last;
+    };
+
+    // Callers hold mutex_
+    void refill(Bucket& bucket, int64_t rate, Clock::time_point now) const;
+    Bucket& stream_bucket(const std::string& stream_name, Clock::time_point now);
+    void prune_idle(Clock::time_point now);
+    size_t burst_size() const;
+
+    int64_t stream_rate_;
+    int64_t global_rate_;
+    int max_paced_;
+    int paced_ = 0;
+    std::mutex mutex_;
+    Bucket global_;
+    std::unordered_map<std::string, Bucket> streams_;
+    Clock::time_point last_prune_;
+};
@@ -0,0 +1,202 @@
+#include "core/fmp4_reader.h"
+
+namespace {
+
+constexpr uint32_t kNonSyncSample = 0x00010000;
+
+uint32_t be32(const std::string& b, size_t pos) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(b[pos])) << 24)
+         | (static_cast<uint32_t>(static_cast<unsigned char>(b[pos + 1])) << 16)
+         | (static_cast<uint32_t>(static_cast<unsigned char>(b[pos + 2])) << 8)
+         |  static_cast<uint32_t>(static_cast<unsigned char>(b[pos + 3]));
+}
+
+uint64_t be64(const std::string& b, size_t pos) {
+    return (static_cast<uint64_t>(be32(b, pos)) << 32) | be32(b, pos + 4);
+}
+
+// Walk the child boxes in [start, end), calling fn(type, payload_start, box_end)
+template <typename Fn>
+void for_each_box(const std::string& b, size_t start, size_t end, Fn fn) {
+    size_t pos = start;
+    while (pos + 8 <= end) {
+        uint64_t size = be32(b, pos);
+        std::string type = b.substr(pos + 4, 4);
+        size_t header = 8;
+        if (size == 1 && pos + 16 <= end) {
+            size = be64(b, pos + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = end - pos;
+        }
+        if (size < header || pos + size > end) return;
+        fn(type, pos + header, static_cast<size_t>(pos + size));
+        pos += static_cast<size_t>(size);
+    }
+}
+
+} // anonymous namespace
+
+Fmp4Reader::Fmp4Reader(InitCallback on_init, FragmentCallback on_fragment)
+    : on_init_(std::move(on_init)), on_fragment_(std::move(on_fragment)) {
+}
+
+void Fmp4Reader::feed(const char* data, size_t size) {
+    buffer_.append(data, size);
+
+    size_t pos = 0;
+    while (buffer_.size() - pos >= 8) {
+        uint64_t box_size = be32(buffer_, pos);
+        if (box_size == 1) {
+            if (buffer_.size() - pos < 16) break;
+            box_size = be64(buffer_, pos + 8);
+        }
+        // size 0 ("to end of file") never completes on a live pipe
+        if (box_size < 8) {
+            buffer_.clear();
+            return;
+        }
+        if (buffer_.size() - pos < box_size) break;
+
+        on_box(buffer_.substr(pos + 4, 4), pos, static_cast<size_t>(box_size));
+        pos += static_cast<size_t>(box_size);
+    }
+    buffer_.erase(0, pos);
+}
+
+void Fmp4Reader::on_box(const std::string& type, size_t start, size_t size) {
+    size_t header = be32(buffer_, start) == 1 ? 16 : 8;
+
+    if (type == "ftyp") {
+        init_.assign(buffer_, start, size);
+    } else if (type == "moov") {
+        init_.append(buffer_, start, size);
+        parse_moov(start + header, start + size);
+        if (!init_sent_) {
+            init_sent_ = true;
+            on_init_(init_);
+        }
+    } else if (type == "moof") {
+        pending_ = Fragment{};
+        pending_moof_.assign(buffer_, start, size);
+        parse_moof(start + header, start + size, pending_);
+    } else if (type == "mdat" && !pending_moof_.empty()) {
+        pending_.data = std::move(pending_moof_);
+        pending_.data.append(buffer_, start, size);
+        pending_moof_.clear();
+        on_fragment_(std::move(pending_));
+        pending_ = Fragment{};
+    }
+    // styp, sidx, mfra and friends are not needed for LL-HLS parts
+}
+
+void Fmp4Reader::parse_moov(size_t start, size_t end) {
+    tracks_.clear();
+    for_each_box(buffer_, start, end, [this](const std::string& type, size_t s, size_t e) {
+        if (type == "trak") {
+            Track track;
+            parse_trak(s, e, track);
+            tracks_.push_back(track);
+        } else if (type == "mvex") {
+            for_each_box(buffer_, s, e, [this](const std::string& t, size_t ps, size_t pe) {
+                if (t != "trex" || ps + 24 > pe) return;
+                if (Track* track = find_track(be32(buffer_, ps + 4))) {
+                    track->default_duration = be32(buffer_, ps + 12);
+                    track->default_flags = be32(buffer_, ps + 20);
+                }
+            });
+        }
+    });
+}
+
+void Fmp4Reader::parse_trak(size_t start, size_t end, Track& track) {
+    for_each_box(buffer_, start, end, [this, &track](const std::string& type, size_t s, size_t e) {
+        if (type == "tkhd" && s + 4 <= e) {
+            bool v1 = buffer_[s] == 1;
+            size_t id_pos = s + 4 + (v1 ? 16 : 8);
+            if (id_pos + 4 <= e) track.id = be32(buffer_, id_pos);
+        } else if (type == "mdia") {
+            for_each_box(buffer_, s, e, [this, &track](const std::string& t, size_t ms, size_t me) {
+                if (t == "mdhd" && ms + 4 <= me) {
+                    bool v1 = buffer_[ms] == 1;
+                    size_t ts_pos = ms + 4 + (v1 ? 16 : 8);
+                    if (ts_pos + 4 <= me) track.timescale = be32(buffer_, ts_pos);
+                } else if (t == "hdlr" && ms + 12 <= me) {
+                    track.video = buffer_.compare(ms + 8, 4, "vide") == 0;
+                }
+            });
+        }
+    });
+}
+
+Fmp4Reader::Track* Fmp4Reader::find_track(uint32_t id) {
+    for (auto& t : tracks_) {
+        if (t.id == id) return &t;
+    }
+    return nullptr;
+}
+
+Fmp4Reader::Track* Fmp4Reader::reference_track() {
+    for (auto& t : tracks_) {
+        if (t.video) return &t;
+    }
+    return tracks_.empty() ? nullptr : &tracks_.front();
+}
+
+void Fmp4Reader::parse_moof(size_t start, size_t end, Fragment& fragment) {
+    Track* ref = reference_track();
+
+    for_each_box(buffer_, start, end, [&](const std::string& type, size_t s, size_t e) {
+        if (type != "traf") return;
+
+        Track* track = nullptr;
+        uint32_t default_duration = 0, default_flags = 0;
+
+        for_each_box(buffer_, s, e, [&](const std::string& t, size_t bs, size_t be) {
+            if (t == "tfhd" && bs + 8 <= be) {
+                uint32_t flags = be32(buffer_, bs) & 0xffffff;
+                track = find_track(be32(buffer_, bs + 4));
+                if (track) {
+                    default_duration = track->default_duration;
+                    default_flags = track->default_flags;
+                }
+                size_t pos = bs + 8;
+                if (flags & 0x01) pos += 8;   // base_data_offset
+                if (flags & 0x02) pos += 4;   // sample_description_index
+                if (flags & 0x08) { if (pos + 4 <= be) default_duration = be32(buffer_, pos); pos += 4; }
+                if (flags & 0x10) pos += 4;   // default_sample_size
+                if (flags & 0x20) { if (pos + 4 <= be) default_flags = be32(buffer_, pos); }
+            } else if (t == "trun" && bs + 8 <= be && track && track == ref) {
+                uint32_t flags = be32(buffer_, bs) & 0xffffff;
+                uint32_t count = be32(buffer_, bs + 4);
+                size_t pos = bs + 8;
+                if (flags & 0x01) pos += 4;   // data_offset
+                bool have_first_flags = flags & 0x04;
+                uint32_t first_flags = 0;
+                if (have_first_flags) {
+                    if (pos + 4 > be) return;
+                    first_flags = be32(buffer_, pos);
+                    pos += 4;
+                }
+
+                uint64_t duration = 0;
+                for (uint32_t i = 0; i < count; ++i) {
+                    uint32_t sample_duration = default_duration;
+                    uint32_t sample_flags = default_flags;
+                    if (flags & 0x100) { if (pos + 4 > be) break; sample_duration = be32(buffer_, pos); pos += 4; }
+                    if (flags & 0x200) pos += 4;
+                    if (flags & 0x400) { if (pos + 4 > be) break; sample_flags = be32(buffer_, pos); pos += 4; }
+                    if (flags & 0x800) pos += 4;
+                    if (i == 0) {
+                        if (have_first_flags) sample_flags = first_flags;
+                        fragment.independent = !(sample_flags & kNonSyncSample);
+                    }
+                    duration += sample_duration;
+                }
+                if (track->timescale > 0) {
+                    fragment.duration += static_cast<double>(duration) / track->timescale;
+                }
+            }
+        });
+    });
+}
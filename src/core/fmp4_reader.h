@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// Incremental reader for a fragmented MP4 byte stream (as written by
+// `ffmpeg -f mp4 -movflags empty_moov+default_base_moof+frag_keyframe`).
+// Emits the initialization segment (ftyp+moov) once, then one fragment
+// per moof+mdat pair with its duration and whether it starts on a sync
+// sample of the video track.
+class Fmp4Reader {
+public:
+    struct Fragment {
+        std::string data;
+        double duration = 0;       // seconds, of the reference track
+        bool independent = false;  // first sample is a keyframe
+    };
+
+    using InitCallback = std::function<void(std::string init)>;
+    using FragmentCallback = std::function<void(Fragment fragment)>;
+
+    Fmp4Reader(InitCallback on_init, FragmentCallback on_fragment);
+
+    // Feed more bytes; complete boxes are consumed from the internal buffer
+    void feed(const char* data, size_t size);
+
+private:
+    struct Track {
+        uint32_t id = 0;
+        uint32_t timescale = 0;
+        bool video = false;
+        uint32_t default_duration = 0;
+        uint32_t default_flags = 0;
+    };
+
+    void on_box(const std::string& type, size_t start, size_t size);
+    void parse_moov(size_t start, size_t end);
+    void parse_trak(size_t start, size_t end, Track& track);
+    void parse_moof(size_t start, size_t end, Fragment& fragment);
+    Track* reference_track();
+    Track* find_track(uint32_t id);
+
+    InitCallback on_init_;
+    FragmentCallback on_fragment_;
+    std::string buffer_;
+    std::string init_;
+    bool init_sent_ = false;
+    std::string pending_moof_;
+    Fragment pending_;
+    std::vector<Track> tracks_;
+};
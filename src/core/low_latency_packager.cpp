@@ -0,0 +1,302 @@
+#include "core/low_latency_packager.h"
+#include "core/fmp4_reader.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+namespace {
+
+std::string fmt_seconds(double s) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", s);
+    return buf;
+}
+
+} // anonymous namespace
+
+LowLatencyStream::LowLatencyStream(const std::string& name, const std::string& source_url,
+                                   const LowLatencyConfig& config)
+    : name_(name)
+    , source_url_(source_url)
+    , ffmpeg_(config.ffmpeg)
+    , part_target_(std::max(50, config.part_target_ms) / 1000.0)
+    , segment_target_(std::max(config.part_target_ms, config.segment_target_ms) / 1000.0)
+    , max_segments_(std::max(3, config.segments)) {
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%llx", static_cast<unsigned long long>(now_ms));
+    generation_ = buf;
+}
+
+LowLatencyStream::~LowLatencyStream() {
+    stop();
+}
+
+bool LowLatencyStream::start() {
+    auto frag_us = std::to_string(static_cast<int64_t>(part_target_ * 1e6));
+    std::vector<std::string> argv = {
+        ffmpeg_, "-hide_banner", "-loglevel", "error", "-nostdin",
+        "-fflags", "nobuffer", "-i", source_url_,
+        "-c", "copy", "-f", "mp4",
+        "-movflags", "empty_moov+default_base_moof+frag_keyframe",
+        "-frag_duration", frag_us, "-flush_packets", "1", "pipe:1"
+    };
+
+    if (!process_.spawn(argv)) {
+        Logger::warn("Low-latency packager: cannot start " + ffmpeg_ + " for " + name_);
+        return false;
+    }
+
+    running_ = true;
+    reader_thread_ = std::thread([this]() { reader(); });
+    Logger::info("Low-latency packager started: " + name_);
+    return true;
+}
+
+void LowLatencyStream::stop() {
+    process_.terminate();
+    if (reader_thread_.joinable()) {
+        reader_thread_.join();
+    }
+    process_.wait();
+    running_ = false;
+    cv_.notify_all();
+}
+
+void LowLatencyStream::reader() {
+    Fmp4Reader parser(
+        [this](std::string init) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            init_ = std::make_shared<const std::string>(std::move(init));
+        },
+        [this](Fmp4Reader::Fragment fragment) {
+            add_part(std::move(fragment.data), fragment.duration, fragment.independent);
+        });
+
+    char buf[65536];
+    while (true) {
+        ssize_t n = read(process_.stdout_fd(), buf, sizeof(buf));
+        if (n <= 0) break;
+        parser.feed(buf, static_cast<size_t>(n));
+    }
+
+    Logger::info("Low-latency packager ended: " + name_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+}
+
+void LowLatencyStream::add_part(std::string data, double duration, bool independent) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Playback has to begin on a keyframe
+        if (segments_.empty() && !independent) return;
+
+        if (segments_.empty()
+            || (independent && segments_.back().duration >= segment_target_)) {
+            int64_t msn = 0;
+            if (!segments_.empty()) {
+                auto& done = segments_.back();
+                done.complete = true;
+                max_segment_duration_ = std::max(max_segment_duration_, done.duration);
+                msn = done.msn + 1;
+            }
+            Segment seg;
+            seg.msn = msn;
+            segments_.push_back(std::move(seg));
+
+            // Keep max_segments_ complete ones plus the one in progress
+            while (segments_.size() > max_segments_ + 1) {
+                segments_.pop_front();
+            }
+        }
+
+        auto& seg = segments_.back();
+        seg.parts.push_back({std::make_shared<const std::string>(std::move(data)), duration, independent});
+        seg.duration += duration;
+        max_part_duration_ = std::max(max_part_duration_, duration);
+    }
+    cv_.notify_all();
+}
+
+const LowLatencyStream::Segment* LowLatencyStream::find(int64_t msn) const {
+    if (segments_.empty() || msn < segments_.front().msn || msn > segments_.back().msn) {
+        return nullptr;
+    }
+    return &segments_[static_cast<size_t>(msn - segments_.front().msn)];
+}
+
+bool LowLatencyStream::has(int64_t msn, int part) const {
+    const Segment* seg = find(msn);
+    if (!seg) return !segments_.empty() && msn < segments_.front().msn;
+    if (part < 0) return seg->complete;
+    return seg->complete || static_cast<int>(seg->parts.size()) > part;
+}
+
+double LowLatencyStream::part_target() const {
+    // PART-TARGET must not be shorter than any part actually produced
+    return std::max(part_target_, std::ceil(max_part_duration_ * 1000.0) / 1000.0);
+}
+
+std::string LowLatencyStream::render() const {
+    if (segments_.empty() || !init_) return {};
+
+    double pt = part_target();
+    int target = static_cast<int>(std::ceil(std::max(segment_target_, max_segment_duration_)));
+
+    std::string out = "#EXTM3U\n#EXT-X-VERSION:9\n";
+    out += "#EXT-X-TARGETDURATION:" + std::to_string(target) + "\n";
+    out += "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=" + fmt_seconds(3 * pt) + "\n";
+    out += "#EXT-X-PART-INF:PART-TARGET=" + fmt_seconds(pt) + "\n";
+    out += "#EXT-X-MEDIA-SEQUENCE:" + std::to_string(segments_.front().msn) + "\n";
+    out += "#EXT-X-MAP:URI=\"" + generation_ + "/init.mp4\"\n";
+
+    // Parts are only listed for the segments closest to the live edge
+    size_t parts_from = segments_.size() > 3 ? segments_.size() - 3 : 0;
+    for (size_t i = 0; i < segments_.size(); ++i) {
+        const auto& seg = segments_[i];
+        std::string base = generation_ + "/seg" + std::to_string(seg.msn);
+        if (i >= parts_from) {
+            for (size_t p = 0; p < seg.parts.size(); ++p) {
+                out += "#EXT-X-PART:DURATION=" + fmt_seconds(seg.parts[p].duration)
+                     + ",URI=\"" + base + "." + std::to_string(p) + ".m4s\""
+                     + (seg.parts[p].independent ? ",INDEPENDENT=YES" : "") + "\n";
+            }
+        }
+        if (seg.complete) {
+            out += "#EXTINF:" + fmt_seconds(seg.duration) + ",\n" + base + ".m4s\n";
+        }
+    }
+
+    const auto& live = segments_.back();
+    out += "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"" + generation_ + "/seg" + std::to_string(live.msn) + "."
+         + std::to_string(live.parts.size()) + ".m4s\"\n";
+    return out;
+}
+
+LowLatencyStream::Status LowLatencyStream::playlist(int64_t msn, int part, std::string& out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (msn >= 0) {
+        // Requests more than two segments ahead of the live edge are errors
+        if (!segments_.empty() && msn > segments_.back().msn + 2) {
+            return Status::BadRequest;
+        }
+        auto timeout = std::chrono::duration<double>(3 * std::max(segment_target_, max_segment_duration_));
+        bool ready = cv_.wait_for(lock, timeout, [&]() { return !running_ || has(msn, part); });
+        if (!ready) {
+            out = render();
+            return Status::Timeout;
+        }
+    }
+
+    out = render();
+    return Status::Ready;
+}
+
+std::shared_ptr<const std::string> LowLatencyStream::init() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return init_;
+}
+
+std::shared_ptr<const std::string> LowLatencyStream::segment(int64_t msn) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Segment* seg = find(msn);
+    if (!seg || !seg->complete) return nullptr;
+
+    auto data = std::make_shared<std::string>();
+    for (const auto& p : seg->parts) *data += *p.data;
+    return data;
+}
+
+std::shared_ptr<const std::string> LowLatencyStream::part(int64_t msn, int index, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto lookup = [&]() -> std::shared_ptr<const std::string> {
+        const Segment* seg = find(msn);
+        if (!seg || index < 0 || index >= static_cast<int>(seg->parts.size())) return nullptr;
+        return seg->parts[index].data;
+    };
+
+    auto data = lookup();
+    if (data || !wait || segments_.empty()) return data;
+
+    // Only hold requests for the part right at the live edge
+    const auto& live = segments_.back();
+    bool next_in_live = msn == live.msn && index == static_cast<int>(live.parts.size());
+    bool first_of_next = msn == live.msn + 1 && index == 0;
+    if (!next_in_live && !first_of_next) return nullptr;
+
+    auto timeout = std::chrono::duration<double>(segment_target_ + 3 * part_target());
+    cv_.wait_for(lock, timeout, [&]() {
+        if (!running_) return true;
+        if (lookup()) return true;
+        // The segment ended before this part index was produced
+        const Segment* seg = find(msn);
+        return seg && seg->complete;
+    });
+    return lookup();
+}
+
+LowLatencyPackager::LowLatencyPackager(const LowLatencyConfig& config, const RtmpConfig& rtmp)
+    : config_(config)
+    , source_base_("rtmp://127.0.0.1:" + std::to_string(rtmp.port) + "/" + rtmp.application + "/") {
+}
+
+LowLatencyPackager::~LowLatencyPackager() {
+    stop_all();
+}
+
+bool LowLatencyPackager::enabled() const {
+    return config_.enabled;
+}
+
+void LowLatencyPackager::sync(const std::vector<StreamInfo>& streams) {
+    if (!config_.enabled) return;
+
+    std::vector<std::shared_ptr<LowLatencyStream>> stopped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& s : streams) {
+            auto it = streams_.find(s.name);
+            if (s.live) {
+                // (Re)start when missing or when ffmpeg has exited
+                if (it != streams_.end() && it->second->running()) continue;
+                if (it != streams_.end()) stopped.push_back(std::move(it->second));
+                auto ll = std::make_shared<LowLatencyStream>(s.name, source_base_ + s.name, config_);
+                if (ll->start()) {
+                    streams_[s.name] = std::move(ll);
+                } else if (it != streams_.end()) {
+                    streams_.erase(it);
+                }
+            } else if (it != streams_.end()) {
+                stopped.push_back(std::move(it->second));
+                streams_.erase(it);
+            }
+        }
+    }
+    // Joining reader threads happens outside the lock
+    for (auto& ll : stopped) ll->stop();
+}
+
+void LowLatencyPackager::stop_all() {
+    std::unordered_map<std::string, std::shared_ptr<LowLatencyStream>> streams;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        streams.swap(streams_);
+    }
+    for (auto& [name, ll] : streams) ll->stop();
+}
+
+std::shared_ptr<LowLatencyStream> LowLatencyPackager::get(const std::string& stream_name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream_name);
+    return it != streams_.end() ? it->second : nullptr;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "core/config.h"
+#include "core/stream_manager.h"
+#include "utils/process.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+
+// One live stream repackaged as CMAF (fragmented MP4) for LL-HLS. ffmpeg
+// pulls the RTMP stream from nginx and remuxes it without transcoding;
+// each moof+mdat fragment becomes an LL-HLS partial segment, and parts are
+// grouped into full segments at keyframes. Everything is kept in memory.
+class LowLatencyStream {
+public:
+    enum class Status { Ready, Timeout, BadRequest };
+
+    LowLatencyStream(const std::string& name, const std::string& source_url, const LowLatencyConfig& config);
+    ~LowLatencyStream();
+
+    bool start();
+    void stop();
+    bool running() const { return running_; }
+
+    // Prefix of every media URI in the playlist ("<generation>/seg3.1.m4s").
+    // Each packager gets a new one, so sequence numbers that restart from 0
+    // never collide with responses cached from an earlier run.
+    const std::string& generation() const { return generation_; }
+
+    // Media playlist. With msn >= 0 this is a blocking reload
+    // (_HLS_msn / _HLS_part) that waits until that segment or part exists.
+    Status playlist(int64_t msn, int part, std::string& out);
+
+    std::shared_ptr<const std::string> init() const;
+    std::shared_ptr<const std::string> segment(int64_t msn) const;
+
+    // A partial segment; with `wait` the request for the next, not yet
+    // produced part (the preload hint) is held until it is available.
+    std::shared_ptr<const std::string> part(int64_t msn, int index, bool wait);
+
+private:
+    struct Part {
+        std::shared_ptr<const std::string> data;
+        double duration;
+        bool independent;
+    };
+
+    struct Segment {
+        int64_t msn = 0;
+        double duration = 0;
+        bool complete = false;
+        std::vector<Part> parts;
+    };
+
+    void reader();
+    void add_part(std::string data, double duration, bool independent);
+    bool has(int64_t msn, int part) const;
+    const Segment* find(int64_t msn) const;
+    std::string render() const;
+    double part_target() const;
+
+    std::string name_;
+    std::string source_url_;
+    std::string generation_;
+    std::string ffmpeg_;
+    double part_target_;
+    double segment_target_;
+    size_t max_segments_;
+
+    ChildProcess process_;
+    std::thread reader_thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::shared_ptr<const std::string> init_;
+    std::deque<Segment> segments_;
+    double max_part_duration_ = 0;
+    double max_segment_duration_ = 0;
+};
+
+// Starts and stops a LowLatencyStream for every live stream
+class LowLatencyPackager {
+public:
+    LowLatencyPackager(const LowLatencyConfig& config, const RtmpConfig& rtmp);
+    ~LowLatencyPackager();
+
+    bool enabled() const;
+
+    // Reconcile packagers with the current stream table (scanner thread)
+    void sync(const std::vector<StreamInfo>& streams);
+    void stop_all();
+
+    std::shared_ptr<LowLatencyStream> get(const std::string& stream_name) const;
+
+private:
+    LowLatencyConfig config_;
+    std::string source_base_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<LowLatencyStream>> streams_;
+};
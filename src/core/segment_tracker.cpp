@@ -0,0 +1,129 @@
+#include "core/segment_tracker.h"
+#include "core/stream_health.h"
+#include "core/stream_manager.h"
+#include "utils/hash.h"
+#include "utils/logger.h"
+#include <sys/inotify.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+SegmentTracker::SegmentTracker(const std::string& hls_path, std::chrono::milliseconds hold)
+    : hls_path_(hls_path)
+    , hold_(hold)
+    , watcher_(hls_path, IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM,
+               [this](const std::string& name, uint32_t mask) { on_event(name, mask); }) {
+}
+
+SegmentTracker::~SegmentTracker() {
+    stop();
+}
+
+bool SegmentTracker::start() {
+    if (!watcher_.start()) {
+        Logger::warn("Segment tracker falling back to playlist checks");
+        return false;
+    }
+    return true;
+}
+
+void SegmentTracker::stop() {
+    watcher_.stop();
+}
+
+bool SegmentTracker::is_segment(const fs::path& file) {
+    auto ext = file.extension();
+    return ext == ".ts" || ext == ".m4s" || ext == ".aac";
+}
+
+std::optional<SegmentRecord> SegmentTracker::await(const std::string& file,
+                                                   std::optional<std::string>* contents) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = ready_.find(file);
+        if (it != ready_.end()) return it->second;
+
+        if (pending_.count(file)) {
+            completed_cv_.wait_for(lock, hold_, [&] { return pending_.count(file) == 0; });
+            it = ready_.find(file);
+            if (it != ready_.end()) return it->second;
+            // Still pending: only trust it if the playlist already lists it
+            // (covers a lost close event)
+        }
+    }
+
+    if (!listed_in_playlist(file)) return std::nullopt;
+    return complete(file, contents);
+}
+
+void SegmentTracker::on_event(const std::string& name, uint32_t mask) {
+    if (name.empty() || !is_segment(name)) return;
+
+    if (mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        complete(name);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.erase(name);
+    if (mask & (IN_CREATE | IN_MODIFY)) {
+        pending_.insert(name);
+    } else {
+        // Deleted or moved away
+        pending_.erase(name);
+        completed_cv_.notify_all();
+    }
+}
+
+std::optional<SegmentRecord> SegmentTracker::complete(const std::string& file,
+                                                      std::optional<std::string>* contents) {
+    std::ifstream ifs(fs::path(hls_path_) / file, std::ios::binary);
+    if (!ifs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.erase(file);
+        completed_cv_.notify_all();
+        return std::nullopt;
+    }
+
+    SegmentRecord record;
+    if (contents) {
+        // The caller is about to serve it, so read it once and hand it over
+        contents->emplace((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        record.checksum = fnv1a_64(**contents);
+        record.size = (*contents)->size();
+    } else {
+        record.checksum = 0xcbf29ce484222325ULL;
+        char buf[64 * 1024];
+        while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0) {
+            size_t n = static_cast<size_t>(ifs.gcount());
+            record.checksum = fnv1a_64(buf, n, record.checksum);
+            record.size += n;
+        }
+    }
+    record.completed_at = std::chrono::system_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_[file] = record;
+    pending_.erase(file);
+    completed_cv_.notify_all();
+    return record;
+}
+
+bool SegmentTracker::listed_in_playlist(const std::string& file) const {
+    fs::path segment(file);
+    fs::path playlist = fs::path(hls_path_) / segment.parent_path()
+                        / (StreamManager::stream_name_for_file(segment) + ".m3u8");
+
+    std::ifstream ifs(playlist);
+    if (!ifs) return false;
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+
+    std::string name = segment.filename().string();
+    for (const auto& s : parse_playlist(ss.str()).segments) {
+        if (fs::path(s.uri).filename() == name) return true;
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "utils/file_watcher.h"
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <filesystem>
+#include <cstdint>
+
+// A segment nginx has finished writing
+struct SegmentRecord {
+    uint64_t size = 0;
+    uint64_t checksum = 0;  // FNV-1a 64 of the contents
+    std::chrono::system_clock::time_point completed_at;
+};
+
+// Tracks which HLS segments are complete so /hls/ never serves one that is
+// still being written. nginx-rtmp writes segments in place: inotify
+// IN_CREATE marks a file pending and IN_CLOSE_WRITE completes it. A
+// rewrite of an existing file (O_TRUNC, no IN_CREATE) is caught by its
+// IN_MODIFY and makes the segment pending again. Files the
+// watcher never saw (written before startup, or no inotify) count as
+// complete once their stream's playlist lists them.
+class SegmentTracker {
+public:
+    SegmentTracker(const std::string& hls_path, std::chrono::milliseconds hold);
+    ~SegmentTracker();
+
+    // Returns false if inotify is unavailable; lookups then rely on playlists
+    bool start();
+    void stop();
+
+    // Record for a completed segment (path relative to the HLS directory).
+    // Waits up to the hold time for a segment still being written; nullopt
+    // means it is not ready and should be answered with 404. If the segment
+    // had to be read to complete it, its contents are stored in *contents.
+    std::optional<SegmentRecord> await(const std::string& file,
+                                       std::optional<std::string>* contents = nullptr);
+
+    static bool is_segment(const std::filesystem::path& file);
+
+private:
+    void on_event(const std::string& name, uint32_t mask);
+    std::optional<SegmentRecord> complete(const std::string& file,
+                                          std::optional<std::string>* contents = nullptr);
+    bool listed_in_playlist(const std::string& file) const;
+
+    std::string hls_path_;
+    std::chrono::milliseconds hold_;
+    FileWatcher watcher_;
+
+    std::mutex mutex_;
+    std::condition_variable completed_cv_;
+    std::unordered_map<std::string, SegmentRecord> ready_;
+    std::unordered_set<std::string> pending_;
+};
@@ -0,0 +1,217 @@
+#include "core/state_snapshot.h"
+#include "utils/hash.h"
+#include "utils/logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Layout (native byte order, the file never leaves the host):
+//   magic u32, version u32, payload size u64, payload checksum u64, payload
+// The payload is written_at, total bytes, the stream records and the
+// client records; strings are a u16 length followed by the bytes.
+constexpr uint32_t SNAPSHOT_MAGIC = 0x53534e50;  // "SSNP"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr size_t HEADER_SIZE = 4 + 4 + 8 + 8;
+
+int64_t to_millis(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_millis(int64_t ms) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+}
+
+class Writer {
+public:
+    template <typename T>
+    void put(T value) {
+        out_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put_string(const std::string& s) {
+        uint16_t len = static_cast<uint16_t>(std::min<size_t>(s.size(), UINT16_MAX));
+        put(len);
+        out_.append(s.data(), len);
+    }
+
+    std::string& data() { return out_; }
+
+private:
+    std::string out_;
+};
+
+class Reader {
+public:
+    Reader(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end_ - p_) < sizeof(T)) return false;
+        std::memcpy(&value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool get_string(std::string& s) {
+        uint16_t len;
+        if (!get(len) || static_cast<size_t>(end_ - p_) < len) return false;
+        s.assign(p_, len);
+        p_ += len;
+        return true;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool decode(const char* data, size_t size, StateSnapshot& snapshot) {
+    Reader header(data, size);
+    uint32_t magic, version;
+    uint64_t payload_size, checksum;
+    if (!header.get(magic) || !header.get(version) || !header.get(payload_size) || !header.get(checksum)) {
+        return false;
+    }
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) return false;
+    if (payload_size != size - HEADER_SIZE) return false;
+
+    const char* payload = data + HEADER_SIZE;
+    if (fnv1a_64(payload, payload_size) != checksum) return false;
+
+    Reader in(payload, payload_size);
+    int64_t written_at;
+    uint32_t stream_count, client_count;
+    if (!in.get(written_at) || !in.get(snapshot.total_bytes_served) || !in.get(stream_count)) return false;
+    snapshot.written_at = from_millis(written_at);
+
+    snapshot.streams.clear();
+    for (uint32_t i = 0; i < stream_count; ++i) {
+        StreamInfo info;
+        uint8_t live;
+        int64_t started_at;
+        int32_t viewers;
+        if (!in.get_string(info.name) || !in.get(live) || !in.get(started_at) || !in.get(viewers) ||
+            !in.get(info.bytes_served) || !in.get(info.playlist_requests) || !in.get(info.segment_requests)) {
+            return false;
+        }
+        info.live = live != 0;
+        info.started_at = from_millis(started_at);
+        info.viewer_estimate = viewers;
+        snapshot.streams.push_back(std::move(info));
+    }
+
+    if (!in.get(client_count)) return false;
+    snapshot.clients.clear();
+    for (uint32_t i = 0; i < client_count; ++i) {
+        std::string stream;
+        ClientUsage usage;
+        int64_t last_seen;
+        if (!in.get_string(stream) || !in.get_string(usage.address) ||
+            !in.get(usage.bytes_served) || !in.get(last_seen)) {
+            return false;
+        }
+        usage.last_seen = from_millis(last_seen);
+        snapshot.clients.emplace_back(std::move(stream), std::move(usage));
+    }
+    return true;
+}
+
+} // namespace
+
+bool write_snapshot(const std::string& path, const StateSnapshot& snapshot) {
+    Writer payload;
+    payload.put<int64_t>(to_millis(snapshot.written_at));
+    payload.put<uint64_t>(snapshot.total_bytes_served);
+    payload.put<uint32_t>(static_cast<uint32_t>(snapshot.streams.size()));
+    for (const auto& info : snapshot.streams) {
+        payload.put_string(info.name);
+        payload.put<uint8_t>(info.live ? 1 : 0);
+        payload.put<int64_t>(to_millis(info.started_at));
+        payload.put<int32_t>(info.viewer_estimate);
+        payload.put<uint64_t>(info.bytes_served);
+        payload.put<uint64_t>(info.playlist_requests);
+        payload.put<uint64_t>(info.segment_requests);
+    }
+    payload.put<uint32_t>(static_cast<uint32_t>(snapshot.clients.size()));
+    for (const auto& [stream, usage] : snapshot.clients) {
+        payload.put_string(stream);
+        payload.put_string(usage.address);
+        payload.put<uint64_t>(usage.bytes_served);
+        payload.put<int64_t>(to_millis(usage.last_seen));
+    }
+
+    Writer file;
+    file.put<uint32_t>(SNAPSHOT_MAGIC);
+    file.put<uint32_t>(SNAPSHOT_VERSION);
+    file.put<uint64_t>(payload.data().size());
+    file.put<uint64_t>(fnv1a_64(payload.data()));
+    file.data() += payload.data();
+
+    std::string tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    bool ok = write_all(fd, file.data().data(), file.data().size()) && ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (!ok || ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        int err = errno;
+        ::unlink(tmp_path.c_str());
+        errno = err;
+        return false;
+    }
+
+    // Persist the rename itself
+    std::string dir = fs::path(path).parent_path().string();
+    int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+bool read_snapshot(const std::string& path, StateSnapshot& snapshot) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    bool ok = decode(static_cast<const char*>(map), size, snapshot);
+    ::munmap(map, size);
+    if (!ok) {
+        Logger::warn("Ignoring unreadable state snapshot: " + path);
+    }
+    return ok;
+}
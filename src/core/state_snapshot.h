@@ -0,0 +1,23 @@
+#pragma once
+
+#include "core/stream_manager.h"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// Stream table and egress counters as persisted across restarts
+struct StateSnapshot {
+    std::chrono::system_clock::time_point written_at;
+    uint64_t total_bytes_served = 0;
+    std::vector<StreamInfo> streams;
+    std::vector<std::pair<std::string, ClientUsage>> clients;  // stream name, usage
+};
+
+// Writes the snapshot to `path + ".tmp"`, fsyncs it and renames it over
+// `path`, so a crash leaves either the old or the new file, never half of one.
+bool write_snapshot(const std::string& path, const StateSnapshot& snapshot);
+
+// Memory-maps and decodes a snapshot. Returns false if the file is missing,
+// truncated, from another format version or fails its checksum.
+bool read_snapshot(const std::string& path, StateSnapshot& snapshot);
@@ -0,0 +1,188 @@
+#include "core/stream_health.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+double to_seconds(fs::file_time_type t) {
+    return std::chrono::duration<double>(t.time_since_epoch()).count();
+}
+
+bool starts_with(const std::string& s, const char* prefix) {
+    return s.rfind(prefix, 0) == 0;
+}
+
+} // anonymous namespace
+
+Playlist parse_playlist(const std::string& text) {
+    Playlist pl;
+    std::istringstream in(text);
+    std::string line;
+    double pending_duration = -1;
+    int64_t sequence = 0;
+
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        if (starts_with(line, "#EXT-X-TARGETDURATION:")) {
+            pl.target_duration = std::atof(line.c_str() + 22);
+        } else if (starts_with(line, "#EXT-X-MEDIA-SEQUENCE:")) {
+            pl.media_sequence = std::atoll(line.c_str() + 22);
+            sequence = pl.media_sequence;
+        } else if (starts_with(line, "#EXTINF:")) {
+            pending_duration = std::atof(line.c_str() + 8);
+        } else if (starts_with(line, "#EXT-X-ENDLIST")) {
+            pl.ended = true;
+        } else if (line[0] != '#' && pending_duration >= 0) {
+            PlaylistSegment seg;
+            seg.sequence = sequence++;
+            seg.duration = pending_duration;
+            seg.uri = line;
+            pl.segments.push_back(std::move(seg));
+            pending_duration = -1;
+        }
+    }
+    return pl;
+}
+
+StreamHealthMonitor::StreamHealthMonitor(const std::string& hls_path)
+    : hls_path_(hls_path) {
+}
+
+void StreamHealthMonitor::update(const std::string& stream_name, fs::file_time_type mtime) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = states_.find(stream_name);
+        if (it != states_.end() && it->second.mtime == mtime) return;
+    }
+
+    // Parse outside the lock; only one scanner thread calls update()
+    fs::path dir(hls_path_);
+    std::ifstream ifs(dir / (stream_name + ".m3u8"));
+    std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    Playlist pl = parse_playlist(text);
+
+    std::vector<Sample> fresh;
+    int64_t last_sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_sequence = states_[stream_name].last_sequence;
+    }
+
+    // A sequence below what we've seen means the encoder restarted
+    bool restarted = !pl.segments.empty() && pl.segments.back().sequence < last_sequence;
+    if (restarted) last_sequence = -1;
+
+    for (const auto& seg : pl.segments) {
+        if (seg.sequence <= last_sequence) continue;
+
+        Sample s{seg.sequence, seg.duration, false, 0, 0, 0};
+        std::error_code ec;
+        fs::path seg_path = dir / seg.uri;
+        auto seg_mtime = fs::last_write_time(seg_path, ec);
+        if (!ec) {
+            s.has_arrival = true;
+            s.arrival = to_seconds(seg_mtime);
+        }
+        auto size = fs::file_size(seg_path, ec);
+        if (!ec) s.bytes = size;
+        fresh.push_back(s);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = states_[stream_name];
+    if (restarted) {
+        Logger::info("Stream health reset (sequence restarted): " + stream_name);
+        state = State{};
+    }
+    state.mtime = mtime;
+    state.target_duration = pl.target_duration;
+
+    for (const auto& s : fresh) {
+        Sample sample = s;
+        if (state.last_sequence >= 0 && s.sequence > state.last_sequence + 1) {
+            sample.gap_before = s.sequence - state.last_sequence - 1;
+            state.missing += sample.gap_before;
+        }
+        state.last_sequence = s.sequence;
+        state.observed++;
+        state.window.push_back(sample);
+    }
+    while (state.window.size() > kWindow) {
+        state.window.pop_front();
+    }
+}
+
+StreamHealth StreamHealthMonitor::get(const std::string& stream_name) const {
+    StreamHealth h;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = states_.find(stream_name);
+    if (it == states_.end() || it->second.window.empty()) {
+        return h;
+    }
+    const auto& state = it->second;
+
+    h.target_duration = state.target_duration;
+    h.segments_observed = state.observed;
+    h.missing_segments = state.missing;
+
+    double total_duration = 0, total_bits = 0, jitter_sum = 0;
+    int jitter_count = 0;
+    uint64_t recent_missing = 0;
+    const Sample* prev = nullptr;
+    for (const auto& s : state.window) {
+        total_duration += s.duration;
+        total_bits += s.bytes * 8.0;
+        h.max_segment_duration = std::max(h.max_segment_duration, s.duration);
+        recent_missing += s.gap_before;
+        // Segment N is finished roughly duration(N) after segment N-1
+        if (prev && prev->has_arrival && s.has_arrival && s.sequence == prev->sequence + 1) {
+            jitter_sum += std::abs((s.arrival - prev->arrival) - s.duration);
+            jitter_count++;
+        }
+        prev = &s;
+    }
+
+    const auto& last = state.window.back();
+    h.avg_segment_duration = total_duration / state.window.size();
+    if (total_duration > 0) h.avg_bitrate_kbps = total_bits / total_duration / 1000.0;
+    if (last.duration > 0) h.last_bitrate_kbps = last.bytes * 8.0 / last.duration / 1000.0;
+    if (jitter_count > 0) h.arrival_jitter = jitter_sum / jitter_count;
+    if (last.has_arrival) {
+        h.seconds_since_segment = to_seconds(fs::file_time_type::clock::now()) - last.arrival;
+    }
+
+    double target = state.target_duration > 0 ? state.target_duration : h.max_segment_duration;
+    int score = 100;
+
+    if (target > 0 && h.seconds_since_segment > 3 * target) {
+        score -= 50;
+        h.alerts.push_back("stalled: no new segment for " + std::to_string(static_cast<int>(h.seconds_since_segment)) + "s");
+    }
+    if (target > 0 && h.arrival_jitter > 0.5 * target) {
+        score -= 20;
+        h.alerts.push_back("late segments: arrival jitter exceeds half the target duration");
+    }
+    if (h.avg_segment_duration > 0 && h.max_segment_duration > 1.5 * h.avg_segment_duration) {
+        score -= 15;
+        h.alerts.push_back("irregular segment durations: check encoder keyframe interval");
+    }
+    if (recent_missing > 0) {
+        score -= static_cast<int>(std::min<uint64_t>(30, recent_missing * 10));
+        h.alerts.push_back("missing media sequences: " + std::to_string(recent_missing));
+    }
+    if (h.avg_bitrate_kbps > 0 && h.last_bitrate_kbps < 0.5 * h.avg_bitrate_kbps) {
+        score -= 15;
+        h.alerts.push_back("bitrate drop: last segment below half the average");
+    }
+
+    h.score = std::max(0, score);
+    return h;
+}
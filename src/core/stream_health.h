@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <cstdint>
+
+struct PlaylistSegment {
+    int64_t sequence = 0;
+    double duration = 0;
+    std::string uri;
+};
+
+struct Playlist {
+    double target_duration = 0;
+    int64_t media_sequence = 0;
+    bool ended = false;
+    std::vector<PlaylistSegment> segments;
+};
+
+// Parse a media playlist (.m3u8). Unknown tags are ignored.
+Playlist parse_playlist(const std::string& text);
+
+struct StreamHealth {
+    int score = 100;                  // 0 (broken) .. 100 (healthy)
+    double target_duration = 0;
+    double avg_segment_duration = 0;
+    double max_segment_duration = 0;
+    double arrival_jitter = 0;        // mean |arrival gap - segment duration|, seconds
+    double avg_bitrate_kbps = 0;
+    double last_bitrate_kbps = 0;
+    double seconds_since_segment = 0;
+    uint64_t segments_observed = 0;
+    uint64_t missing_segments = 0;
+    std::vector<std::string> alerts;
+};
+
+// Tracks segment cadence, bitrate and sequence gaps per stream. Playlists
+// are only re-parsed when their mtime changes.
+class StreamHealthMonitor {
+public:
+    explicit StreamHealthMonitor(const std::string& hls_path);
+
+    // Analyze the stream's playlist if it changed since the last update
+    void update(const std::string& stream_name, std::filesystem::file_time_type mtime);
+
+    StreamHealth get(const std::string& stream_name) const;
+
+private:
+    struct Sample {
+        int64_t sequence;
+        double duration;
+        bool has_arrival;   // false if the segment was already cleaned up
+        double arrival;     // segment mtime, seconds on the filesystem clock
+        uint64_t bytes;
+        uint64_t gap_before;  // sequences skipped just before this one
+    };
+
+    struct State {
+        std::filesystem::file_time_type mtime;
+        double target_duration = 0;
+        int64_t last_sequence = -1;
+        uint64_t observed = 0;
+        uint64_t missing = 0;
+        std::deque<Sample> window;
+    };
+
+    static constexpr size_t kWindow = 30;
+
+    std::string hls_path_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, State> states_;
+};
@@ -1,11 +1,13 @@
 #include "core/stream_manager.h"
+#include "core/state_snapshot.h"
 #include "utils/logger.h"
 #include <algorithm>
 
 namespace fs = std::filesystem;
 
 StreamManager::StreamManager(const std::string& hls_path)
-    : hls_path_(hls_path) {
+    : hls_path_(hls_path)
+    , health_(hls_path) {
     // Ensure HLS directory exists
     if (!fs::exists(hls_path_)) {
         Logger::warn("HLS path does not exist: " + hls_path_);
@@ -19,6 +21,7 @@ void StreamManager::on_publish(const std::string& stream_name) {
     info.live = true;
     info.started_at = std::chrono::system_clock::now();
     info.viewer_estimate = 0;
+    unverified_.erase(stream_name);
     Logger::info("Stream started: " + stream_name);
 }
 
@@ -76,46 +79,190 @@ void StreamManager::record_viewer_activity(const std::string& stream_name) {
     }
 }
 
-void StreamManager::scan_hls_directory() {
+void StreamManager::record_request(const std::string& stream_name, bool is_playlist) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(stream_name);
+    if (it != streams_.end()) {
+        if (is_playlist) it->second.playlist_requests++;
+        else it->second.segment_requests++;
+    }
+}
+
+void StreamManager::record_bytes_served(const std::string& stream_name, const std::string& client, uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_bytes_served_ += bytes;
+
+    auto it = streams_.find(stream_name);
+    if (it == streams_.end()) return;
+    it->second.bytes_served += bytes;
+
+    auto& usage = clients_[stream_name][client];
+    usage.address = client;
+    usage.bytes_served += bytes;
+    usage.last_seen = std::chrono::system_clock::now();
+}
+
+std::vector<ClientUsage> StreamManager::get_client_usage(const std::string& stream_name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ClientUsage> result;
+    auto it = clients_.find(stream_name);
+    if (it == clients_.end()) return result;
+
+    result.reserve(it->second.size());
+    for (const auto& [addr, usage] : it->second) {
+        result.push_back(usage);
+    }
+    std::sort(result.begin(), result.end(), [](const ClientUsage& a, const ClientUsage& b) {
+        return a.bytes_served > b.bytes_served;
+    });
+    return result;
+}
+
+uint64_t StreamManager::total_bytes_served() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_served_;
+}
+
+std::string StreamManager::stream_name_for_file(const fs::path& file) {
+    std::string stem = file.stem().string();
+    if (file.extension() == ".m3u8") return stem;
+
+    // nginx-rtmp names segments <stream>-<sequence>.ts
+    auto dash = stem.rfind('-');
+    if (dash != std::string::npos && dash > 0) {
+        return stem.substr(0, dash);
+    }
+    return stem;
+}
+
+void StreamManager::prune_idle_clients() {
+    // Forget clients that have not fetched anything for 5 minutes
+    auto cutoff = std::chrono::system_clock::now() - std::chrono::minutes(5);
+    for (auto& [name, clients] : clients_) {
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (it->second.last_seen < cutoff) it = clients.erase(it);
+            else ++it;
+        }
+    }
+}
 
-    if (!fs::exists(hls_path_)) return;
+void StreamManager::scan_hls_directory() {
+    // Playlists that are being written, analyzed for health after the scan
+    std::vector<std::pair<std::string, fs::file_time_type>> active;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        prune_idle_clients();
 
-    for (const auto& entry : fs::directory_iterator(hls_path_)) {
-        if (entry.path().extension() == ".m3u8") {
-            std::string name = entry.path().stem().string();
+        if (!fs::exists(hls_path_)) {
+            end_unverified_streams();
+            return;
+        }
 
-            // Check if the m3u8 file was recently modified (within 30 seconds)
-            auto last_write = fs::last_write_time(entry);
-            auto now = fs::file_time_type::clock::now();
-            auto age = std::chrono::duration_cast<std::chrono::seconds>(now - last_write);
+        for (const auto& entry : fs::directory_iterator(hls_path_)) {
+            if (entry.path().extension() == ".m3u8") {
+                std::string name = entry.path().stem().string();
+                unverified_.erase(name);
 
-            bool recently_active = age.count() < 30;
+                // Check if the m3u8 file was recently modified (within 30 seconds)
+                auto last_write = fs::last_write_time(entry);
+                auto now = fs::file_time_type::clock::now();
+                auto age = std::chrono::duration_cast<std::chrono::seconds>(now - last_write);
 
-            auto it = streams_.find(name);
-            if (it == streams_.end()) {
-                StreamInfo info;
-                info.name = name;
-                info.live = recently_active;
+                bool recently_active = age.count() < 30;
                 if (recently_active) {
-                    info.started_at = std::chrono::system_clock::now();
+                    active.emplace_back(name, last_write);
                 }
-                streams_[name] = info;
-            } else {
-                // Update liveness based on file activity
-                if (recently_active && !it->second.live) {
-                    it->second.live = true;
-                    it->second.started_at = std::chrono::system_clock::now();
-                    Logger::info("Stream detected via HLS scan: " + name);
-                } else if (!recently_active && it->second.live) {
-                    it->second.live = false;
-                    Logger::info("Stream ended (detected via HLS scan): " + name);
+
+                auto it = streams_.find(name);
+                if (it == streams_.end()) {
+                    StreamInfo info;
+                    info.name = name;
+                    info.live = recently_active;
+                    if (recently_active) {
+                        info.started_at = std::chrono::system_clock::now();
+                    }
+                    streams_[name] = info;
+                } else {
+                    // Update liveness based on file activity
+                    if (recently_active && !it->second.live) {
+                        it->second.live = true;
+                        it->second.started_at = std::chrono::system_clock::now();
+                        Logger::info("Stream detected via HLS scan: " + name);
+                    } else if (!recently_active && it->second.live) {
+                        it->second.live = false;
+                        Logger::info("Stream ended (detected via HLS scan): " + name);
+                    }
                 }
             }
         }
+
+        end_unverified_streams();
+    }
+
+    // Health analysis re-parses only playlists whose mtime changed
+    for (const auto& [name, mtime] : active) {
+        health_.update(name, mtime);
+    }
+}
+
+void StreamManager::snapshot(StateSnapshot& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.written_at = std::chrono::system_clock::now();
+    out.total_bytes_served = total_bytes_served_;
+    out.streams.clear();
+    out.streams.reserve(streams_.size());
+    for (const auto& [name, info] : streams_) {
+        out.streams.push_back(info);
+    }
+    out.clients.clear();
+    for (const auto& [name, clients] : clients_) {
+        for (const auto& [addr, usage] : clients) {
+            out.clients.emplace_back(name, usage);
+        }
     }
 }
 
+void StreamManager::restore(const StateSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // A stream counts as live while its playlist changed in the last 30
+    // seconds; an older snapshot cannot vouch for any of them.
+    auto age = std::chrono::system_clock::now() - snapshot.written_at;
+    bool fresh = age < std::chrono::seconds(30);
+
+    total_bytes_served_ += snapshot.total_bytes_served;
+    for (const auto& saved : snapshot.streams) {
+        auto [it, inserted] = streams_.emplace(saved.name, saved);
+        if (!inserted) continue;
+        if (fresh && saved.live) {
+            unverified_.insert(saved.name);
+        } else {
+            it->second.live = false;
+        }
+    }
+    for (const auto& [name, usage] : snapshot.clients) {
+        clients_[name].emplace(usage.address, usage);
+    }
+    prune_idle_clients();
+}
+
+void StreamManager::end_unverified_streams() {
+    // Streams restored from a snapshot whose playlist is gone
+    for (const auto& name : unverified_) {
+        auto it = streams_.find(name);
+        if (it != streams_.end() && it->second.live) {
+            it->second.live = false;
+            Logger::info("Stream ended while the service was down: " + name);
+        }
+    }
+    unverified_.clear();
+}
+
+StreamHealth StreamManager::get_health(const std::string& stream_name) const {
+    return health_.get(stream_name);
+}
+
 bool StreamManager::hls_files_exist(const std::string& stream_name) const {
     auto m3u8_path = fs::path(hls_path_) / (stream_name + ".m3u8");
     if (!fs::exists(m3u8_path)) return false;
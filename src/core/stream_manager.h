@@ -1,11 +1,14 @@
 #pragma once
 
+#include "core/stream_health.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <chrono>
 #include <filesystem>
+#include <cstdint>
 
 struct StreamInfo {
     std::string name;
@@ -13,6 +16,19 @@ struct StreamInfo {
     std::chrono::system_clock::time_point started_at;
     int viewer_estimate = 0;
     std::chrono::system_clock::time_point last_viewer_ping;
+
+    // Egress accounting for /hls/ traffic
+    uint64_t bytes_served = 0;
+    uint64_t playlist_requests = 0;
+    uint64_t segment_requests = 0;
+};
+
+struct StateSnapshot;
+
+struct ClientUsage {
+    std::string address;
+    uint64_t bytes_served = 0;
+    std::chrono::system_clock::time_point last_seen;
 };
 
 class StreamManager {
@@ -31,13 +47,39 @@ public:
     // Track viewer activity (called on HLS requests)
     void record_viewer_activity(const std::string& stream_name);
 
+    // Account bytes sent for a stream's playlist or segment to a client
+    void record_request(const std::string& stream_name, bool is_playlist);
+    void record_bytes_served(const std::string& stream_name, const std::string& client, uint64_t bytes);
+    std::vector<ClientUsage> get_client_usage(const std::string& stream_name) const;
+    uint64_t total_bytes_served() const;
+
+    // Map an HLS file name ("stream.m3u8", "stream-12.ts") to its stream name
+    static std::string stream_name_for_file(const std::filesystem::path& file);
+
+    // Segment cadence / bitrate analysis, updated by scan_hls_directory()
+    StreamHealth get_health(const std::string& stream_name) const;
+
     // Scan HLS directory for active streams (fallback detection)
     void scan_hls_directory();
 
+    // Persisted state. restore() seeds an empty manager at startup; streams
+    // it marks live are confirmed or dropped by the next scan.
+    void snapshot(StateSnapshot& out) const;
+    void restore(const StateSnapshot& snapshot);
+
 private:
     std::string hls_path_;
     mutable std::mutex mutex_;
     std::unordered_map<std::string, StreamInfo> streams_;
+    // Per-client usage, keyed by stream then client address
+    std::unordered_map<std::string, std::unordered_map<std::string, ClientUsage>> clients_;
+    uint64_t total_bytes_served_ = 0;
+    StreamHealthMonitor health_;
+    // Restored as live but not yet seen by a scan
+    std::unordered_set<std::string> unverified_;
+
+    void prune_idle_clients();
+    void end_unverified_streams();
 
     bool hls_files_exist(const std::string& stream_name) const;
 };
@@ -0,0 +1,180 @@
+#include "core/thumbnail_pipeline.h"
+#include "core/config.h"
+#include "core/stream_health.h"
+#include "utils/logger.h"
+#include "utils/process.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kSpriteColumns = 5;
+constexpr int kLowestPriority = 19;
+
+} // anonymous namespace
+
+ThumbnailPipeline::ThumbnailPipeline(const std::string& hls_path, const ThumbnailConfig& config)
+    : hls_path_(hls_path)
+    , ffmpeg_(config.ffmpeg)
+    , interval_(std::max(1, config.interval_seconds))
+    , workers_(std::max(1, config.workers))
+    , width_(config.width)
+    , sprite_frames_(std::max(1, config.sprite_frames))
+    , enabled_(config.enabled) {
+}
+
+ThumbnailPipeline::~ThumbnailPipeline() {
+    stop();
+}
+
+void ThumbnailPipeline::start() {
+    if (!enabled_ || running_) return;
+    running_ = true;
+    for (int i = 0; i < workers_; ++i) {
+        threads_.emplace_back([this]() { worker(); });
+    }
+    Logger::info("Thumbnail pipeline started with " + std::to_string(workers_) + " worker(s)");
+}
+
+void ThumbnailPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+    threads_.clear();
+}
+
+void ThumbnailPipeline::schedule(const std::vector<StreamInfo>& streams) {
+    if (!running_) return;
+
+    auto now = std::chrono::steady_clock::now();
+    bool added = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& s : streams) {
+            if (!s.live) continue;
+            auto& state = states_[s.name];
+            if (state.queued || now - state.last_run < interval_) continue;
+            // Bounded queue: skip this round rather than pile up work
+            if (queue_.size() >= static_cast<size_t>(workers_) * 4) break;
+            state.queued = true;
+            queue_.push_back(s.name);
+            added = true;
+        }
+    }
+    if (added) cv_.notify_all();
+}
+
+StreamPreview ThumbnailPipeline::get(const std::string& stream_name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = states_.find(stream_name);
+    if (it == states_.end()) return {};
+    return it->second.preview;
+}
+
+void ThumbnailPipeline::worker() {
+    while (true) {
+        std::string name;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (!running_) return;
+            name = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        generate(name);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& state = states_[name];
+        state.queued = false;
+        state.last_run = std::chrono::steady_clock::now();
+    }
+}
+
+bool ThumbnailPipeline::run_ffmpeg(const std::vector<std::string>& args, std::string& jpeg,
+                                   const std::string& input) {
+    std::vector<std::string> argv = {ffmpeg_, "-hide_banner", "-loglevel", "error", "-threads", "1"};
+    if (input.empty()) argv.push_back("-nostdin");
+    argv.insert(argv.end(), args.begin(), args.end());
+
+    ProcessOptions options;
+    options.input = input;
+    options.niceness = kLowestPriority;
+
+    int rc = run_capture(argv, jpeg, options);
+    if (rc == 127) {
+        Logger::warn("Thumbnail pipeline: cannot run " + ffmpeg_ + ", disabling");
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        return false;
+    }
+    return rc == 0 && !jpeg.empty();
+}
+
+void ThumbnailPipeline::generate(const std::string& stream_name) {
+    fs::path dir(hls_path_);
+    std::ifstream ifs(dir / (stream_name + ".m3u8"));
+    std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    Playlist pl = parse_playlist(text);
+    if (pl.segments.empty()) return;
+
+    const std::string& segment = pl.segments.back().uri;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (states_[stream_name].last_segment == segment) return;
+    }
+
+    // First keyframe of the newest complete segment
+    std::string jpeg;
+    std::string scale = "scale=" + std::to_string(width_) + ":-2";
+    if (!run_ffmpeg({"-skip_frame", "nokey", "-i", (dir / segment).string(),
+                     "-frames:v", "1", "-vf", scale, "-q:v", "5",
+                     "-f", "image2pipe", "-c:v", "mjpeg", "pipe:1"}, jpeg)) {
+        return;
+    }
+    auto thumb = std::make_shared<const std::string>(std::move(jpeg));
+
+    std::string frames;
+    int count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& state = states_[stream_name];
+        state.last_segment = segment;
+        state.recent.push_back(thumb);
+        while (state.recent.size() > static_cast<size_t>(sprite_frames_)) {
+            state.recent.pop_front();
+        }
+        state.preview.thumbnail = thumb;
+        state.preview.updated_at = std::chrono::system_clock::now();
+        for (const auto& t : state.recent) frames += *t;
+        count = static_cast<int>(state.recent.size());
+    }
+
+    // Tile the recent thumbnails (fed back in as an MJPEG stream) into one sheet
+    int columns = std::min(count, kSpriteColumns);
+    int rows = (count + columns - 1) / columns;
+    std::string sprite;
+    if (!run_ffmpeg({"-f", "image2pipe", "-c:v", "mjpeg", "-i", "pipe:0",
+                     "-vf", "tile=" + std::to_string(columns) + "x" + std::to_string(rows),
+                     "-frames:v", "1", "-q:v", "5",
+                     "-f", "image2pipe", "-c:v", "mjpeg", "pipe:1"}, sprite, frames)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& preview = states_[stream_name].preview;
+    preview.sprite = std::make_shared<const std::string>(std::move(sprite));
+    preview.sprite_columns = columns;
+    preview.sprite_frames = count;
+}
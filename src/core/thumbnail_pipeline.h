@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/stream_manager.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+struct ThumbnailConfig;
+
+struct StreamPreview {
+    std::shared_ptr<const std::string> thumbnail;   // latest JPEG
+    std::shared_ptr<const std::string> sprite;      // JPEG grid of recent thumbnails
+    int sprite_columns = 0;
+    int sprite_frames = 0;
+    std::chrono::system_clock::time_point updated_at;
+};
+
+// Periodically grabs a keyframe from the newest segment of each live stream
+// with ffmpeg and keeps JPEG thumbnails and a rolling sprite sheet in memory.
+// Work runs on a small, bounded pool of low-priority workers.
+class ThumbnailPipeline {
+public:
+    ThumbnailPipeline(const std::string& hls_path, const ThumbnailConfig& config);
+    ~ThumbnailPipeline();
+
+    void start();
+    void stop();
+
+    // Queue live streams whose thumbnail is older than the interval.
+    // Called from the stream scanner; never blocks on ffmpeg.
+    void schedule(const std::vector<StreamInfo>& streams);
+
+    StreamPreview get(const std::string& stream_name) const;
+
+private:
+    struct State {
+        std::string last_segment;
+        std::chrono::steady_clock::time_point last_run;
+        bool queued = false;
+        std::deque<std::shared_ptr<const std::string>> recent;
+        StreamPreview preview;
+    };
+
+    void worker();
+    void generate(const std::string& stream_name);
+    bool run_ffmpeg(const std::vector<std::string>& args, std::string& jpeg, const std::string& input = {});
+
+    std::string hls_path_;
+    std::string ffmpeg_;
+    std::chrono::seconds interval_;
+    int workers_;
+    int width_;
+    int sprite_frames_;
+    bool enabled_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> queue_;
+    std::unordered_map<std::string, State> states_;
+    std::atomic<bool> running_{false};
+    std::vector<std::thread> threads_;
+};
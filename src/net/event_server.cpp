@@ -0,0 +1,681 @@
+#include "net/event_server.h"
+#include "utils/logger.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kMaxHeaderBytes = 16 * 1024;
+constexpr size_t kMaxBodyBytes = 1024 * 1024;
+// The next content provider call is scheduled once unsent output drops below this
+constexpr size_t kProduceWatermark = 256 * 1024;
+
+bool iequals(const std::string& a, const char* b) {
+    size_t n = std::strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return {};
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+std::string canned_response(int status) {
+    return "HTTP/1.1 " + std::to_string(status) + " " + httplib::status_message(status)
+         + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+}
+
+} // anonymous namespace
+
+struct EventServer::Connection {
+    int fd = -1;
+    std::string remote_addr;
+    int remote_port = 0;
+
+    // Loop thread only
+    std::string in;
+    bool busy = false;          // a request is being handled
+    bool want_write = false;    // output pending, poll for EPOLLOUT
+    uint32_t events = 0;        // currently registered epoll events
+    bool peer_closed = false;
+    std::chrono::steady_clock::time_point last_active;
+    std::chrono::steady_clock::time_point last_write;   // output last drained or advanced
+
+    // Shared with the worker handling the current request
+    std::mutex mutex;
+    std::string out;
+    size_t out_offset = 0;
+    bool response_done = false;
+    bool keep_alive = true;
+    bool closed = false;
+    bool woken = false;
+    std::shared_ptr<BodyProducer> producer;  // streamed body still being produced
+    bool producing = false;                  // a provider call is queued or running
+};
+
+// A content provider response being streamed to a connection
+struct EventServer::BodyProducer {
+    std::shared_ptr<httplib::Response> res;
+    size_t offset = 0;
+    size_t length = 0;
+    bool chunked = false;
+    bool finished = false;
+    bool keep_alive = true;
+};
+
+EventServer::EventServer(Router& router, int worker_threads, size_t max_connections,
+                         std::chrono::seconds idle_timeout)
+    : router_(router)
+    , worker_count_(std::max(1, worker_threads))
+    , max_connections_(max_connections)
+    , idle_timeout_(idle_timeout) {
+    // Created up front so stop() can wake the loop at any time, even from a
+    // signal handler before listen() has run
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    spare_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+EventServer::~EventServer() {
+    stop();
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    if (spare_fd_ >= 0) close(spare_fd_);
+}
+
+bool EventServer::listen(const std::string& host, int port) {
+    if (epoll_fd_ < 0 || wake_fd_ < 0) return false;
+    // stop() may already have been called, e.g. by an early SIGTERM
+    if (stopping_) return true;
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+        return false;
+    }
+
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            listen_fd_ = fd;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(result);
+    if (listen_fd_ < 0) return false;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    for (int i = 0; i < worker_count_; ++i) {
+        workers_.emplace_back([this]() { worker(); });
+    }
+    Logger::info("Event server listening with " + std::to_string(worker_count_) + " workers");
+
+    loop();
+
+    // Shut down: close every connection, then drain workers
+    for (auto& [fd, conn] : std::unordered_map<int, ConnectionPtr>(connections_)) {
+        close_connection(conn);
+    }
+    {
+        // stop() cannot take this lock, so take it here before waking the workers
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+    }
+    jobs_cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+    workers_.clear();
+
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return true;
+}
+
+void EventServer::stop() {
+    // Async-signal-safe: only an atomic store and an eventfd write. The loop
+    // wakes the workers once it has exited.
+    if (stopping_.exchange(true)) return;
+    uint64_t one = 1;
+    if (wake_fd_ >= 0) {
+        ssize_t n = write(wake_fd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+void EventServer::loop() {
+    std::vector<epoll_event> events(1024);
+    auto last_sweep = std::chrono::steady_clock::now();
+
+    while (!stopping_) {
+        int n = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), 1000);
+        if (n < 0 && errno != EINTR) break;
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if (fd == listen_fd_) {
+                accept_all();
+                continue;
+            }
+            if (fd == wake_fd_) {
+                uint64_t count;
+                ssize_t r = read(wake_fd_, &count, sizeof(count));
+                (void)r;
+                std::vector<ConnectionPtr> woken;
+                {
+                    std::lock_guard<std::mutex> lock(wake_mutex_);
+                    woken.swap(woken_);
+                }
+                for (auto& conn : woken) {
+                    {
+                        std::lock_guard<std::mutex> lock(conn->mutex);
+                        conn->woken = false;
+                    }
+                    auto it = connections_.find(conn->fd);
+                    if (it != connections_.end() && it->second == conn) {
+                        on_writable(conn);
+                    }
+                }
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            ConnectionPtr conn = it->second;
+
+            if (flags & EPOLLERR) {
+                close_connection(conn);
+                continue;
+            }
+            if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) on_readable(conn);
+            if ((flags & EPOLLOUT) && connections_.count(fd)) on_writable(conn);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sweep >= std::chrono::seconds(1)) {
+            sweep_idle();
+            last_sweep = now;
+        }
+    }
+}
+
+void EventServer::accept_all() {
+    while (true) {
+        sockaddr_storage addr{};
+        socklen_t len = sizeof(addr);
+        int fd = accept4(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if ((errno == EMFILE || errno == ENFILE) && spare_fd_ >= 0) {
+                // Out of descriptors: the pending connection would keep the
+                // listener readable and spin the loop. Free the spare fd to
+                // accept and drop it, then take the spare back.
+                auto now = std::chrono::steady_clock::now();
+                if (now - fd_warned_ >= std::chrono::minutes(1)) {
+                    Logger::warn("Out of file descriptors; dropping new connections (raise LimitNOFILE)");
+                    fd_warned_ = now;
+                }
+                close(spare_fd_);
+                fd = accept(listen_fd_, nullptr, nullptr);
+                if (fd >= 0) close(fd);
+                spare_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                if (fd >= 0) continue;
+            }
+            return;
+        }
+
+        if (connections_.size() >= max_connections_) {
+            std::string busy = canned_response(503);
+            ssize_t n = write(fd, busy.data(), busy.size());
+            (void)n;
+            close(fd);
+            continue;
+        }
+
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        auto conn = std::make_shared<Connection>();
+        conn->fd = fd;
+        conn->last_active = conn->last_write = std::chrono::steady_clock::now();
+        char host[INET6_ADDRSTRLEN] = {0};
+        if (addr.ss_family == AF_INET) {
+            auto* sin = reinterpret_cast<sockaddr_in*>(&addr);
+            inet_ntop(AF_INET, &sin->sin_addr, host, sizeof(host));
+            conn->remote_port = ntohs(sin->sin_port);
+        } else if (addr.ss_family == AF_INET6) {
+            auto* sin6 = reinterpret_cast<sockaddr_in6*>(&addr);
+            inet_ntop(AF_INET6, &sin6->sin6_addr, host, sizeof(host));
+            conn->remote_port = ntohs(sin6->sin6_port);
+        }
+        conn->remote_addr = host;
+
+        epoll_event ev{};
+        ev.events = conn->events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+        connections_[fd] = std::move(conn);
+    }
+}
+
+void EventServer::on_readable(const ConnectionPtr& conn) {
+    char buf[16384];
+    while (true) {
+        ssize_t n = read(conn->fd, buf, sizeof(buf));
+        if (n > 0) {
+            conn->in.append(buf, n);
+            continue;
+        }
+        if (n == 0) conn->peer_closed = true;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) conn->peer_closed = true;
+        break;
+    }
+    conn->last_active = std::chrono::steady_clock::now();
+
+    if (conn->busy) {
+        // Pipelined bytes wait until the current response is done;
+        // a peer that hung up is closed once the worker finishes
+        if (conn->in.size() > kMaxHeaderBytes + kMaxBodyBytes) close_connection(conn);
+        else update_interest(conn);
+        return;
+    }
+    // A request and the EOF after it can arrive in one read: answer
+    // whatever complete request is buffered before closing
+    try_dispatch(conn);
+    if (conn->peer_closed && !conn->busy) close_connection(conn);
+}
+
+void EventServer::try_dispatch(const ConnectionPtr& conn) {
+    size_t header_end = conn->in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        if (conn->in.size() > kMaxHeaderBytes) reject(conn, 431);
+        return;
+    }
+
+    httplib::Request req;
+    std::string head = conn->in.substr(0, header_end);
+    size_t line_end = head.find("\r\n");
+    std::string request_line = head.substr(0, line_end);
+
+    size_t sp1 = request_line.find(' ');
+    size_t sp2 = request_line.rfind(' ');
+    bool bad = sp1 == std::string::npos || sp2 == sp1;
+    if (!bad) {
+        req.method = request_line.substr(0, sp1);
+        req.target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+        req.version = request_line.substr(sp2 + 1);
+    }
+
+    size_t content_length = 0;
+    size_t pos = line_end == std::string::npos ? head.size() : line_end + 2;
+    while (!bad && pos < head.size()) {
+        size_t eol = head.find("\r\n", pos);
+        if (eol == std::string::npos) eol = head.size();
+        std::string line = head.substr(pos, eol - pos);
+        pos = eol + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        std::string value = trim(line.substr(colon + 1));
+        if (iequals(name, "Content-Length")) content_length = std::strtoul(value.c_str(), nullptr, 10);
+        if (iequals(name, "Transfer-Encoding")) bad = true;   // chunked uploads are not supported
+        req.headers.emplace(std::move(name), std::move(value));
+    }
+
+    if (bad || content_length > kMaxBodyBytes) {
+        reject(conn, bad ? 400 : 413);
+        return;
+    }
+
+    size_t total = header_end + 4 + content_length;
+    if (conn->in.size() < total) return;
+
+    req.body = conn->in.substr(header_end + 4, content_length);
+    conn->in.erase(0, total);
+
+    size_t q = req.target.find('?');
+    req.path = httplib::detail::decode_url(req.target.substr(0, q), false);
+    if (q != std::string::npos) {
+        httplib::detail::parse_query_text(req.target.substr(q + 1), req.params);
+    }
+    if (req.get_header_value("Content-Type").rfind("application/x-www-form-urlencoded", 0) == 0) {
+        httplib::detail::parse_query_text(req.body, req.params);
+    }
+    req.remote_addr = conn->remote_addr;
+    req.remote_port = conn->remote_port;
+
+    conn->busy = true;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->response_done = false;
+        conn->out.clear();
+        conn->out_offset = 0;
+    }
+
+    post([this, conn, req = std::move(req)]() mutable { handle(conn, std::move(req)); });
+}
+
+void EventServer::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobs_cv_.notify_one();
+}
+
+void EventServer::reject(const ConnectionPtr& conn, int status) {
+    conn->busy = true;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->out = canned_response(status);
+        conn->out_offset = 0;
+        conn->response_done = true;
+        conn->keep_alive = false;
+    }
+    on_writable(conn);
+}
+
+void EventServer::on_writable(const ConnectionPtr& conn) {
+    bool done;
+    bool keep_alive;
+    bool pending;
+    bool sent = false;
+    std::shared_ptr<BodyProducer> next;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        while (conn->out_offset < conn->out.size()) {
+            ssize_t n = ::send(conn->fd, conn->out.data() + conn->out_offset,
+                               conn->out.size() - conn->out_offset, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn->out_offset += n;
+                sent = true;
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            conn->closed = true;
+            break;
+        }
+        if (conn->out_offset == conn->out.size()) {
+            conn->out.clear();
+            conn->out_offset = 0;
+        }
+        pending = !conn->out.empty() && !conn->closed;
+        done = (conn->response_done && !pending) || conn->closed;
+        keep_alive = conn->keep_alive && !conn->closed;
+
+        // Client caught up: produce the next piece of a streamed body
+        if (conn->producer && !conn->producing && !conn->closed &&
+            conn->out.size() - conn->out_offset < kProduceWatermark) {
+            conn->producing = true;
+            next = conn->producer;
+        }
+    }
+    if (next) post([this, conn, next]() { produce(conn, next); });
+    conn->last_active = std::chrono::steady_clock::now();
+    if (sent || !pending) conn->last_write = conn->last_active;
+
+    conn->want_write = pending;
+    update_interest(conn);
+
+    if (done) {
+        if (keep_alive) {
+            finish_or_continue(conn);
+        } else {
+            close_connection(conn);
+        }
+    }
+}
+
+void EventServer::finish_or_continue(const ConnectionPtr& conn) {
+    conn->busy = false;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->response_done = false;
+    }
+    if (!conn->in.empty()) try_dispatch(conn);
+    // Pipelined requests sent before the EOF have been answered
+    if (conn->peer_closed && !conn->busy) close_connection(conn);
+}
+
+void EventServer::update_interest(const ConnectionPtr& conn) {
+    if (!connections_.count(conn->fd)) return;
+
+    // Stop polling for input once the peer hung up, or EOF would spin the loop
+    uint32_t events = 0;
+    if (!conn->peer_closed) events |= EPOLLIN | EPOLLRDHUP;
+    if (conn->want_write) events |= EPOLLOUT;
+    if (events == conn->events) return;
+
+    conn->events = events;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = conn->fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+void EventServer::close_connection(const ConnectionPtr& conn) {
+    auto it = connections_.find(conn->fd);
+    if (it == connections_.end() || it->second != conn) return;
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    connections_.erase(it);
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->closed = true;
+    }
+}
+
+void EventServer::sweep_idle() {
+    // Idle connections, and busy ones whose client has stopped reading the
+    // response, are closed after idle_timeout. A busy connection still
+    // waiting on its handler is left alone.
+    auto cutoff = std::chrono::steady_clock::now() - idle_timeout_;
+    std::vector<ConnectionPtr> idle;
+    for (const auto& [fd, conn] : connections_) {
+        bool stalled = conn->busy ? conn->want_write && conn->last_write < cutoff
+                                  : conn->last_active < cutoff;
+        if (stalled) idle.push_back(conn);
+    }
+    for (auto& conn : idle) close_connection(conn);
+}
+
+void EventServer::worker() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex_);
+            jobs_cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_ && jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+    }
+}
+
+void EventServer::handle(const ConnectionPtr& conn, httplib::Request req) {
+    // Shared so a streamed body can outlive this call
+    auto res = std::make_shared<httplib::Response>();
+    bool head_only = req.method == "HEAD";
+
+    bool keep_alive = req.version == "HTTP/1.1";
+    std::string connection = req.get_header_value("Connection");
+    if (iequals(connection, "close")) keep_alive = false;
+    if (iequals(connection, "keep-alive")) keep_alive = true;
+
+    try {
+        if (!router_.dispatch(req, *res)) res->status = 404;
+    } catch (const std::exception& e) {
+        Logger::error("Handler error for " + req.path + ": " + e.what());
+        res->status = 500;
+        res->headers.clear();
+        res->body.clear();
+        res->content_provider_ = nullptr;
+    }
+    if (res->status == -1) res->status = 200;
+
+    bool chunked = res->content_provider_ && res->is_chunked_content_provider_;
+    size_t length = res->content_provider_ ? res->content_length_ : res->body.size();
+
+    std::string head = "HTTP/1.1 " + std::to_string(res->status) + " " + httplib::status_message(res->status) + "\r\n";
+    for (const auto& [name, value] : res->headers) {
+        head += name + ": " + value + "\r\n";
+    }
+    if (chunked) head += "Transfer-Encoding: chunked\r\n";
+    else head += "Content-Length: " + std::to_string(length) + "\r\n";
+    head += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    if (head_only || !res->content_provider_) {
+        if (!head_only) head += res->body;
+        bool ok = send(conn, head.data(), head.size());
+        complete(conn, keep_alive && ok);
+        return;
+    }
+
+    if (!send(conn, head.data(), head.size())) {
+        complete(conn, false);
+        return;
+    }
+
+    auto producer = std::make_shared<BodyProducer>();
+    producer->res = res;
+    producer->length = length;
+    producer->chunked = chunked;
+    producer->keep_alive = keep_alive;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->producer = producer;
+        conn->producing = true;
+    }
+    produce(conn, producer);
+}
+
+void EventServer::produce(const ConnectionPtr& conn, const std::shared_ptr<BodyProducer>& producer) {
+    // One content provider call; the loop schedules the next one once the
+    // client has read most of what this call wrote
+    httplib::Response& res = *producer->res;
+
+    httplib::DataSink sink;
+    sink.write = [&](const char* data, size_t size) {
+        if (size == 0) return true;
+        bool ok;
+        if (producer->chunked) {
+            char prefix[32];
+            int n = std::snprintf(prefix, sizeof(prefix), "%zx\r\n", size);
+            std::string chunk(prefix, n);
+            chunk.append(data, size);
+            chunk += "\r\n";
+            ok = send(conn, chunk.data(), chunk.size());
+        } else {
+            ok = send(conn, data, size);
+        }
+        if (ok) producer->offset += size;
+        return ok;
+    };
+    sink.is_writable = [&]() {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        return !conn->closed;
+    };
+    sink.done = [&]() { producer->finished = true; };
+
+    bool ok = sink.is_writable();
+    if (ok) {
+        try {
+            ok = producer->chunked ? res.content_provider_(producer->offset, 0, sink)
+                                   : res.content_provider_(producer->offset, producer->length - producer->offset, sink);
+        } catch (const std::exception& e) {
+            // The status line is already out; all that is left is to drop the connection
+            Logger::error(std::string("Content provider error: ") + e.what());
+            ok = false;
+        }
+    }
+
+    bool more = !producer->finished && (producer->chunked || producer->offset < producer->length);
+    if (ok && more) {
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            conn->producing = false;
+        }
+        wake(conn);
+        return;
+    }
+
+    if (ok && producer->chunked) ok = send(conn, "0\r\n\r\n", 5);
+    // httplib::Response runs the resource releaser with this when destroyed
+    res.content_provider_success_ = ok;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->producer.reset();
+        conn->producing = false;
+    }
+    complete(conn, producer->keep_alive && ok);
+}
+
+bool EventServer::send(const ConnectionPtr& conn, const char* data, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->closed) return false;
+        conn->out.append(data, size);
+    }
+    wake(conn);
+    return true;
+}
+
+void EventServer::complete(const ConnectionPtr& conn, bool keep_alive) {
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        conn->response_done = true;
+        conn->keep_alive = keep_alive;
+    }
+    wake(conn);
+}
+
+void EventServer::wake(const ConnectionPtr& conn) {
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->woken) return;
+        conn->woken = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        woken_.push_back(conn);
+    }
+    uint64_t one = 1;
+    ssize_t n = write(wake_fd_, &one, sizeof(one));
+    (void)n;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "api/router.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+// Event-driven HTTP/1.1 server core: one epoll loop owns every socket and a
+// fixed pool of workers runs Router handlers. An idle keep-alive connection
+// costs a small buffer, not a thread, so the connection count is bounded by
+// memory (and max_connections) rather than by the thread pool.
+//
+// Streamed bodies (content providers) are produced one provider call at a
+// time, and the next call is only scheduled once the client has drained the
+// output, so a slow reader parks its response instead of holding a worker.
+// Handlers themselves still run synchronously: a handler that sleeps or waits
+// ties up a worker for that long, so the server only enables features that
+// do so (LL-HLS blocking reloads, egress shaping, segment holds) on the
+// httplib backend.
+class EventServer {
+public:
+    EventServer(Router& router, int worker_threads, size_t max_connections,
+                std::chrono::seconds idle_timeout);
+    ~EventServer();
+
+    // Bind and run the event loop until stop(). Returns false if binding fails.
+    bool listen(const std::string& host, int port);
+    // Safe to call from a signal handler, and before listen()
+    void stop();
+
+private:
+    struct Connection;
+    struct BodyProducer;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    void loop();
+    void accept_all();
+    void on_readable(const ConnectionPtr& conn);
+    void on_writable(const ConnectionPtr& conn);
+    void try_dispatch(const ConnectionPtr& conn);
+    void finish_or_continue(const ConnectionPtr& conn);
+    void close_connection(const ConnectionPtr& conn);
+    void reject(const ConnectionPtr& conn, int status);
+    void update_interest(const ConnectionPtr& conn);
+    void sweep_idle();
+
+    // Worker side
+    void worker();
+    void handle(const ConnectionPtr& conn, httplib::Request req);
+    void produce(const ConnectionPtr& conn, const std::shared_ptr<BodyProducer>& producer);
+    bool send(const ConnectionPtr& conn, const char* data, size_t size);
+    void post(std::function<void()> job);
+    void complete(const ConnectionPtr& conn, bool keep_alive);
+    void wake(const ConnectionPtr& conn);
+
+    Router& router_;
+    int worker_count_;
+    size_t max_connections_;
+    std::chrono::seconds idle_timeout_;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    int spare_fd_ = -1;     // released to shed connections when out of fds
+    std::atomic<bool> stopping_{false};
+
+    // Owned by the loop thread
+    std::unordered_map<int, ConnectionPtr> connections_;
+    std::chrono::steady_clock::time_point fd_warned_;
+
+    // Connections with output or completion for the loop to pick up
+    std::mutex wake_mutex_;
+    std::vector<ConnectionPtr> woken_;
+
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<std::function<void()>> jobs_;
+    std::vector<std::thread> workers_;
+};
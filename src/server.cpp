@@ -1,57 +1,184 @@
 #include "server.h"
 #include "api/stream_api.h"
 #include "api/auth_api.h"
+#include "core/state_snapshot.h"
+#include "utils/hash.h"
 #include "utils/logger.h"
+#include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sys/inotify.h>
 
 namespace fs = std::filesystem;
 
 // Global pointer for signal handling
 static Server* g_server = nullptr;
+static volatile std::sig_atomic_t g_signal = 0;
 
+// Only wakes the listener; run() does the rest of the shutdown once it returns
 static void signal_handler(int sig) {
-    Logger::info("Received signal " + std::to_string(sig) + ", shutting down...");
+    g_signal = sig;
     if (g_server) g_server->stop();
 }
 
+// Viewer address for accounting. nginx proxies everything from loopback,
+// so prefer the X-Real-IP header it sets.
+static std::string client_address(const httplib::Request& req) {
+    if (req.has_header("X-Real-IP")
+        && (req.remote_addr == "127.0.0.1" || req.remote_addr == "::1")) {
+        return req.get_header_value("X-Real-IP");
+    }
+    return req.remote_addr;
+}
+
+// Quality value the Accept-Encoding header gives `coding` (RFC 9110 12.5.3):
+// an explicit entry wins over "*", and "q=0" means not acceptable.
+static double encoding_quality(const std::string& accept, const std::string& coding) {
+    double wildcard = 0.0;
+    size_t pos = 0;
+    while (pos < accept.size()) {
+        size_t end = std::min(accept.find(',', pos), accept.size());
+        std::string item = accept.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t semi = std::min(item.find(';'), item.size());
+        std::string name = item.substr(0, semi);
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        double q = 1.0;
+        size_t qpos = item.find("q=", semi);
+        if (qpos != std::string::npos) {
+            q = std::strtod(item.c_str() + qpos + 2, nullptr);
+        }
+
+        if (name == coding) return q;
+        if (name == "*") wildcard = q;
+    }
+    return wildcard;
+}
+
+// Counts a request against a concurrency cap for as long as it is in scope
+class HoldSlot {
+public:
+    HoldSlot(std::atomic<int>& count, int cap) : count_(count), acquired_(count.fetch_add(1) < cap) {}
+    ~HoldSlot() { count_.fetch_sub(1); }
+    bool acquired() const { return acquired_; }
+
+private:
+    std::atomic<int>& count_;
+    bool acquired_;
+};
+
 Server::Server(const AppConfig& config)
     : config_(config)
     , stream_mgr_(config.hls.path)
-    , auth_mgr_(config.auth.stream_keys, config.auth.enabled) {
+    // A hold would occupy an epoll worker, so there segments still being
+    // written get an immediate 404 instead
+    , segments_(config.hls.path, std::chrono::milliseconds(
+          config.server.backend == "epoll" ? 0 : std::max(0, config.hls.segment_hold_ms)))
+    , auth_mgr_(config.auth.stream_keys, config.auth.enabled)
+    , assets_(config.web.path)
+    , shaper_(config.egress.stream_rate_kbps * 1000 / 8, config.egress.global_rate_kbps * 1000 / 8,
+              config.egress.max_paced_transfers)
+    , thumbs_(config.hls.path, config.thumbnails)
+    , low_latency_(config.low_latency, config.rtmp) {
+    if (config_.server.backend == "epoll") {
+        event_server_ = std::make_unique<EventServer>(router_,
+            config_.server.worker_threads,
+            static_cast<size_t>(std::max(1, config_.server.max_connections)),
+            std::chrono::seconds(std::max(1, config_.server.idle_timeout_seconds)));
+    }
 }
 
 Server::~Server() {
-    stop();
+    shutdown();
 }
 
 void Server::run() {
+    // Set before the signal handlers and the scanner start: a signal clears
+    // it, and the scanner loop exits as soon as it is false
+    running_ = true;
+
     g_server = this;
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+    // Writes to a helper process that exited early must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Answer from the last snapshot until the scanner has reconciled it
+    load_state();
 
     setup_routes();
     setup_hls_serving();
+    setup_low_latency_serving();
     setup_web_serving();
+    thumbs_.start();
     start_stream_scanner();
 
-    running_ = true;
-
     Logger::info("Streaming service backend starting on "
                  + config_.server.host + ":" + std::to_string(config_.server.port));
     Logger::info("HLS path: " + config_.hls.path);
     Logger::info("Web path: " + config_.web.path);
     Logger::info("Auth enabled: " + std::string(config_.auth.enabled ? "yes" : "no"));
+    Logger::info("HTTP backend: " + config_.server.backend);
+
+    bool listening;
+    if (event_server_) {
+        listening = event_server_->listen(config_.server.host, config_.server.port);
+    } else {
+        router_.install(svr_);
+        // httplib runs handlers on a fixed pool. Held LL-HLS requests and
+        // paced segment transfers get threads of their own on top of it, so
+        // they cannot starve everything else.
+        size_t threads = CPPHTTPLIB_THREAD_POOL_COUNT;
+        if (low_latency_.enabled()) threads += std::max(0, config_.low_latency.max_blocking_requests);
+        if (shaper_.enabled()) threads += std::max(1, config_.egress.max_paced_transfers);
+        svr_.new_task_queue = [threads]() { return new httplib::ThreadPool(threads); };
+        // httplib's stop() is a no-op before listen(), so honour an early signal here
+        listening = !running_ || svr_.listen(config_.server.host, config_.server.port);
+    }
 
-    if (!svr_.listen(config_.server.host, config_.server.port)) {
+    if (!listening) {
         Logger::error("Failed to start server on " + config_.server.host
                       + ":" + std::to_string(config_.server.port));
     }
+    if (g_signal != 0) {
+        Logger::info("Received signal " + std::to_string(g_signal) + ", shutting down...");
+    }
+
+    shutdown();
+    // Final snapshot once the scanner has stopped updating the stream table
+    save_state();
 }
 
 void Server::stop() {
+    // Called from the signal handler: no locks, allocation or logging here
     running_ = false;
     svr_.stop();
+    if (event_server_) {
+        event_server_->stop();
+    }
+}
+
+void Server::shutdown() {
+    if (shut_down_) return;
+    shut_down_ = true;
+
+    stop();
+    if (web_watcher_) {
+        web_watcher_->stop();
+    }
+    segments_.stop();
+    thumbs_.stop();
+    low_latency_.stop_all();
     if (scanner_thread_.joinable()) {
         scanner_thread_.join();
     }
@@ -60,30 +187,35 @@ void Server::stop() {
 
 void Server::setup_routes() {
     // Health check
-    svr_.Get("/api/health", [](const httplib::Request&, httplib::Response& res) {
+    router_.Get("/api/health", [](const httplib::Request&, httplib::Response& res, const RouteParams&) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_content(R"({"status":"ok"})", "application/json");
     });
 
     // CORS preflight handler
-    svr_.Options(R"(/api/.*)", [](const httplib::Request&, httplib::Response& res) {
+    auto preflight = [](const httplib::Request&, httplib::Response& res, const RouteParams&) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, DELETE, OPTIONS");
         res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
         res.status = 204;
-    });
+    };
+    router_.Options("/api/", preflight);
+    router_.Options("/api/*path", preflight);
 
     // Register API routes
-    StreamAPI::register_routes(svr_, stream_mgr_);
-    AuthAPI::register_routes(svr_, auth_mgr_);
+    StreamAPI::register_routes(router_, stream_mgr_, thumbs_);
+    AuthAPI::register_routes(router_, auth_mgr_);
 
     Logger::info("API routes registered");
 }
 
 void Server::setup_hls_serving() {
     // Serve HLS files (.m3u8, .ts) from the HLS directory
-    svr_.Get(R"(/hls/(.+))", [this](const httplib::Request& req, httplib::Response& res) {
-        std::string file = req.matches[1];
+    if (segments_.start()) {
+        Logger::info("Segment tracker watching " + config_.hls.path);
+    }
+    router_.Get("/hls/*file", [this](const httplib::Request& req, httplib::Response& res, const RouteParams& params) {
+        std::string file = params["file"];
 
         // Prevent path traversal
         if (file.find("..") != std::string::npos) {
@@ -104,18 +236,71 @@ void Server::setup_hls_serving() {
         if (ext == ".m3u8") content_type = "application/vnd.apple.mpegurl";
         else if (ext == ".ts") content_type = "video/mp2t";
 
-        // Read file
-        std::ifstream ifs(full_path, std::ios::binary);
-        std::string body((std::istreambuf_iterator<char>(ifs)),
-                          std::istreambuf_iterator<char>());
+        bool is_playlist = ext == ".m3u8";
+        std::string stream_name = StreamManager::stream_name_for_file(full_path);
+        std::string client = client_address(req);
 
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Cache-Control", "no-cache");
-        res.set_content(body, content_type);
+
+        // Only serve segments nginx has finished writing
+        std::optional<SegmentRecord> segment;
+        std::optional<std::string> contents;   // set when await() had to read it
+        if (SegmentTracker::is_segment(full_path)) {
+            segment = segments_.await(file, &contents);
+            if (!segment) {
+                res.status = 404;
+                return;
+            }
+            std::string etag = "\"" + hash_to_hex(segment->checksum) + "\"";
+            res.set_header("ETag", etag);
+            if (req.get_header_value("If-None-Match") == etag) {
+                stream_mgr_.record_request(stream_name, false);
+                res.status = 304;
+                return;
+            }
+        }
+
+        std::shared_ptr<std::string> body;
+        if (contents) {
+            body = std::make_shared<std::string>(std::move(*contents));
+        } else {
+            std::ifstream ifs(full_path, std::ios::binary);
+            body = std::make_shared<std::string>((std::istreambuf_iterator<char>(ifs)),
+                                                 std::istreambuf_iterator<char>());
+        }
+
+        // Rewritten since it completed (sequence numbers restart on republish)
+        if (segment && body->size() != segment->size) {
+            res.status = 404;
+            return;
+        }
+
+        stream_mgr_.record_request(stream_name, is_playlist);
+
+        if (is_playlist || !shaper_.enabled()) {
+            stream_mgr_.record_bytes_served(stream_name, client, body->size());
+            res.set_content(std::move(*body), content_type);
+        } else if (!shaper_.begin_paced()) {
+            // Every paced slot is busy: send now and let the paced transfers
+            // pay the bytes back, rather than hold another worker
+            shaper_.charge(stream_name, body->size());
+            stream_mgr_.record_bytes_served(stream_name, client, body->size());
+            res.set_content(std::move(*body), content_type);
+        } else {
+            // Pace segment bodies through the egress shaper
+            res.set_content_provider(body->size(), content_type,
+                [this, body, stream_name, client](size_t offset, size_t length, httplib::DataSink& sink) {
+                    size_t n = shaper_.acquire(stream_name, length);
+                    if (!sink.write(body->data() + offset, n)) return false;
+                    stream_mgr_.record_bytes_served(stream_name, client, n);
+                    return true;
+                },
+                [this](bool) { shaper_.end_paced(); });
+        }
 
         // Track viewer activity for .m3u8 requests
-        if (ext == ".m3u8") {
-            std::string stream_name = full_path.stem().string();
+        if (is_playlist) {
             stream_mgr_.record_viewer_activity(stream_name);
         }
     });
@@ -123,40 +308,180 @@ void Server::setup_hls_serving() {
     Logger::info("HLS serving configured at /hls/");
 }
 
+void Server::setup_low_latency_serving() {
+    if (!low_latency_.enabled()) return;
+
+    // LL-HLS (CMAF) rendition of each live stream, produced in memory
+    router_.Get("/hls/ll/:name/*file", [this](const httplib::Request& req, httplib::Response& res, const RouteParams& params) {
+        std::string name = params["name"];
+        std::string file = params["file"];
+        res.set_header("Access-Control-Allow-Origin", "*");
+
+        auto ll = low_latency_.get(name);
+        if (!ll) {
+            res.status = 404;
+            return;
+        }
+
+        std::shared_ptr<const std::string> body;
+        std::string content_type = "video/mp4";
+        long long msn = -1;
+        int part = -1;
+
+        if (file == "index.m3u8") {
+            if (req.has_param("_HLS_msn")) msn = std::atoll(req.get_param_value("_HLS_msn").c_str());
+            if (req.has_param("_HLS_part")) part = std::atoi(req.get_param_value("_HLS_part").c_str());
+
+            // Over the hold cap a blocking reload gets the current playlist
+            HoldSlot slot(ll_holds_, config_.low_latency.max_blocking_requests);
+            if (!slot.acquired()) msn = part = -1;
+
+            std::string playlist;
+            auto status = ll->playlist(msn, part, playlist);
+            if (status == LowLatencyStream::Status::BadRequest) {
+                res.status = 400;
+                return;
+            }
+            if (status == LowLatencyStream::Status::Timeout) {
+                res.status = 503;
+                res.set_header("Cache-Control", "no-cache");
+                return;
+            }
+            if (playlist.empty()) {
+                res.status = 404;
+                return;
+            }
+            body = std::make_shared<const std::string>(std::move(playlist));
+            content_type = "application/vnd.apple.mpegurl";
+            res.set_header("Cache-Control", "no-cache");
+            stream_mgr_.record_request(name, true);
+            stream_mgr_.record_viewer_activity(name);
+        } else {
+            // Media URIs are "<generation>/<file>"; another generation is a
+            // URI from an earlier run of this stream
+            size_t slash = file.find('/');
+            if (slash == std::string::npos || file.compare(0, slash, ll->generation()) != 0) {
+                res.status = 404;
+                return;
+            }
+            file.erase(0, slash + 1);
+
+            if (file == "init.mp4") {
+                body = ll->init();
+            } else if (std::sscanf(file.c_str(), "seg%lld.%d.m4s", &msn, &part) == 2) {
+                // Over the hold cap a preload hint is only served if it exists
+                HoldSlot slot(ll_holds_, config_.low_latency.max_blocking_requests);
+                body = ll->part(msn, part, slot.acquired());
+            } else if (std::sscanf(file.c_str(), "seg%lld.m4s", &msn) == 1) {
+                body = ll->segment(msn);
+            }
+            if (!body) {
+                res.status = 404;
+                return;
+            }
+            // Parts, segments and the init segment never change within a generation
+            res.set_header("Cache-Control", "max-age=60");
+            stream_mgr_.record_request(name, false);
+        }
+
+        stream_mgr_.record_bytes_served(name, client_address(req), body->size());
+        res.set_content(*body, content_type);
+    });
+
+    Logger::info("Low-latency HLS serving configured at /hls/ll/");
+}
+
 void Server::setup_web_serving() {
-    // Serve the web player
-    std::string web_path = config_.web.path;
+    // Keep the web player in memory, precompressed; reload when files change
+    assets_.reload();
+    web_watcher_ = std::make_unique<FileWatcher>(config_.web.path,
+        IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE,
+        [this](const std::string& name, uint32_t) {
+            Logger::info("Web assets changed (last: " + name + ")");
+            assets_.reload();
+        },
+        // One save or copy fires several events; recompress once per burst.
+        // Assets are loaded from subdirectories too, so watch those as well
+        std::chrono::milliseconds(250), true);
+    web_watcher_->start();
 
     // Serve index.html at /streamingservice and /
-    auto serve_index = [web_path](const httplib::Request&, httplib::Response& res) {
-        fs::path index_path = fs::path(web_path) / "index.html";
-        if (!fs::exists(index_path)) {
+    auto serve_index = [this](const httplib::Request& req, httplib::Response& res, const RouteParams&) {
+        auto asset = assets_.find("index.html");
+        if (!asset) {
             res.status = 404;
             res.set_content("Player page not found", "text/plain");
             return;
         }
-
-        std::ifstream ifs(index_path);
-        std::string body((std::istreambuf_iterator<char>(ifs)),
-                          std::istreambuf_iterator<char>());
-        res.set_content(body, "text/html; charset=utf-8");
+        serve_asset(req, res, *asset, false);
     };
 
-    svr_.Get("/", serve_index);
-    svr_.Get("/streamingservice", serve_index);
-    svr_.Get("/streamingservice/", serve_index);
+    router_.Get("/", serve_index);
+    router_.Get("/streamingservice", serve_index);
+    router_.Get("/streamingservice/", serve_index);
 
-    // Serve static files from web directory
-    svr_.set_mount_point("/static", web_path);
+    // Serve static files from the web directory
+    router_.Get("/static/*path", [this](const httplib::Request& req, httplib::Response& res, const RouteParams& params) {
+        bool immutable = false;
+        auto asset = assets_.find(params["path"], &immutable);
+        if (!asset) {
+            res.status = 404;
+            return;
+        }
+        serve_asset(req, res, *asset, immutable);
+    });
 
     Logger::info("Web player serving configured");
 }
 
+void Server::serve_asset(const httplib::Request& req, httplib::Response& res,
+                         const WebAsset& asset, bool immutable) {
+    // Pick the encoding the client prefers; on a tie, the smaller one (br)
+    std::string accept = req.get_header_value("Accept-Encoding");
+    double br = asset.brotli.empty() ? 0.0 : encoding_quality(accept, "br");
+    double gzip = asset.gzip.empty() ? 0.0 : encoding_quality(accept, "gzip");
+    const std::string* body = &asset.body;
+    std::string encoding;
+    if (br > 0.0 && br >= gzip) {
+        body = &asset.brotli;
+        encoding = "br";
+    } else if (gzip > 0.0) {
+        body = &asset.gzip;
+        encoding = "gzip";
+    }
+
+    // Each encoding is a distinct representation, so it gets its own ETag
+    std::string etag = "\"" + asset.hash + (encoding.empty() ? "" : "-" + encoding) + "\"";
+
+    res.set_header("ETag", etag);
+    res.set_header("Vary", "Accept-Encoding");
+    res.set_header("Cache-Control", immutable ? "public, max-age=31536000, immutable" : "no-cache");
+
+    if (req.get_header_value("If-None-Match").find(etag) != std::string::npos) {
+        res.status = 304;
+        return;
+    }
+
+    if (!encoding.empty()) {
+        res.set_header("Content-Encoding", encoding);
+    }
+    res.set_content(*body, asset.content_type);
+}
+
 void Server::start_stream_scanner() {
     // Background thread to periodically scan HLS directory
     scanner_thread_ = std::thread([this]() {
+        auto snapshot_interval = std::chrono::seconds(std::max(1, config_.state.snapshot_interval_seconds));
+        auto next_snapshot = std::chrono::steady_clock::now() + snapshot_interval;
         while (running_) {
             stream_mgr_.scan_hls_directory();
+            auto streams = stream_mgr_.get_all_streams();
+            thumbs_.schedule(streams);
+            low_latency_.sync(streams);
+            if (std::chrono::steady_clock::now() >= next_snapshot) {
+                save_state();
+                next_snapshot = std::chrono::steady_clock::now() + snapshot_interval;
+            }
             // Sleep 5 seconds between scans
             for (int i = 0; i < 50 && running_; ++i) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -164,3 +489,33 @@ void Server::start_stream_scanner() {
         }
     });
 }
+
+void Server::load_state() {
+    if (config_.state.snapshot_path.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+    StateSnapshot snapshot;
+    if (!read_snapshot(config_.state.snapshot_path, snapshot)) return;
+    stream_mgr_.restore(snapshot);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    Logger::info("Restored " + std::to_string(snapshot.streams.size()) + " streams from "
+                 + config_.state.snapshot_path + " in " + std::to_string(elapsed.count()) + " us");
+}
+
+void Server::save_state() {
+    if (config_.state.snapshot_path.empty()) return;
+
+    // The scanner and the final save in run() may overlap during shutdown
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    StateSnapshot snapshot;
+    stream_mgr_.snapshot(snapshot);
+    bool ok = write_snapshot(config_.state.snapshot_path, snapshot);
+    // Warn once per failure streak, not on every interval
+    if (!ok && !snapshot_failing_) {
+        Logger::warn("Failed to write state snapshot: " + config_.state.snapshot_path
+                     + " (" + std::strerror(errno) + ")");
+    }
+    snapshot_failing_ = !ok;
+}
@@ -1,11 +1,21 @@
 #pragma once
 
+#include "api/router.h"
 #include "core/config.h"
 #include "core/stream_manager.h"
 #include "core/auth_manager.h"
+#include "core/egress_shaper.h"
+#include "core/asset_cache.h"
+#include "core/thumbnail_pipeline.h"
+#include "core/low_latency_packager.h"
+#include "core/segment_tracker.h"
+#include "net/event_server.h"
+#include "utils/file_watcher.h"
 #include <httplib.h>
 #include <atomic>
 #include <thread>
+#include <memory>
+#include <mutex>
 
 class Server {
 public:
@@ -13,18 +23,38 @@ public:
     ~Server();
 
     void run();
+    // Makes run() return; safe to call from a signal handler
     void stop();
 
 private:
     void setup_routes();
     void setup_hls_serving();
+    void setup_low_latency_serving();
     void setup_web_serving();
     void start_stream_scanner();
+    void load_state();
+    void save_state();
+    // Stops every background component; run() and the destructor call it
+    void shutdown();
+    void serve_asset(const httplib::Request& req, httplib::Response& res,
+                     const WebAsset& asset, bool immutable);
 
     AppConfig config_;
     httplib::Server svr_;
+    Router router_;
+    std::unique_ptr<EventServer> event_server_;
     StreamManager stream_mgr_;
+    SegmentTracker segments_;
     AuthManager auth_mgr_;
+    AssetCache assets_;
+    EgressShaper shaper_;
+    ThumbnailPipeline thumbs_;
+    LowLatencyPackager low_latency_;
     std::atomic<bool> running_{false};
+    bool shut_down_ = false;
+    std::atomic<int> ll_holds_{0};   // LL-HLS requests currently held
     std::thread scanner_thread_;
+    std::mutex state_mutex_;         // serializes save_state()
+    bool snapshot_failing_ = false;  // guarded by state_mutex_
+    std::unique_ptr<FileWatcher> web_watcher_;
 };
@@ -0,0 +1,141 @@
+#include "utils/file_watcher.h"
+#include "utils/logger.h"
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+FileWatcher::FileWatcher(const std::string& dir, uint32_t mask, Callback callback,
+                         std::chrono::milliseconds settle, bool recursive)
+    : dir_(dir), mask_(mask), callback_(std::move(callback)), settle_(settle), recursive_(recursive) {
+}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start() {
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        Logger::warn("inotify unavailable: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    if (!add_watch("")) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void FileWatcher::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool FileWatcher::add_watch(const std::string& rel) {
+    std::string path = rel.empty() ? dir_ : dir_ + "/" + rel;
+    // New subdirectories must be seen even if the caller's mask omits them
+    uint32_t mask = recursive_ ? mask_ | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM : mask_;
+    int wd = inotify_add_watch(fd_, path.c_str(), mask);
+    if (wd < 0) {
+        Logger::warn("Cannot watch " + path + ": " + std::string(std::strerror(errno)));
+        return false;
+    }
+    watches_[wd] = rel;
+
+    if (recursive_) {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+                add_watch(rel.empty() ? entry.path().filename().string()
+                                      : rel + "/" + entry.path().filename().string());
+            }
+        }
+    }
+    return true;
+}
+
+void FileWatcher::remove_watches(const std::string& rel) {
+    // A directory moved out of the tree keeps its watch; drop it and its children
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        if (it->second == rel || it->second.compare(0, rel.size() + 1, rel + "/") == 0) {
+            inotify_rm_watch(fd_, it->first);
+            it = watches_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileWatcher::run() {
+    alignas(inotify_event) char buf[4096];
+
+    // Burst being coalesced when settle_ is set
+    std::string pending_name;
+    uint32_t pending_mask = 0;
+    auto last_event = std::chrono::steady_clock::now();
+
+    while (running_) {
+        // Wake up periodically so stop() never waits long
+        int timeout_ms = 200;
+        if (pending_mask != 0) {
+            auto quiet = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - last_event);
+            timeout_ms = static_cast<int>(std::clamp<long long>((settle_ - quiet).count(), 0, 200));
+        }
+
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout_ms);
+
+        ssize_t len = ready > 0 ? read(fd_, buf, sizeof(buf)) : 0;
+        for (char* p = buf; len > 0 && p < buf + len;) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) continue;
+            std::string name = event->len > 0 ? event->name : "";
+            if (!watch->second.empty()) {
+                name = name.empty() ? watch->second : watch->second + "/" + name;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(watch);
+                continue;
+            }
+            if (recursive_ && (event->mask & IN_ISDIR)) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) add_watch(name);
+                if (event->mask & IN_MOVED_FROM) remove_watches(name);
+            }
+            if ((event->mask & mask_) == 0) continue;
+
+            if (settle_.count() == 0) {
+                callback_(name, event->mask);
+            } else {
+                pending_name = std::move(name);
+                pending_mask |= event->mask;
+                last_event = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (pending_mask != 0 && std::chrono::steady_clock::now() - last_event >= settle_) {
+            callback_(pending_name, pending_mask);
+            pending_mask = 0;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+// Watches a single directory with inotify and invokes the callback from a
+// background thread for each event. `mask` is a set of IN_* flags.
+//
+// With a non-zero `settle` time, events are coalesced instead: the callback
+// runs once after the directory has been quiet for that long, with the last
+// event's name and the union of all masks in the burst.
+//
+// A `recursive` watcher also watches every subdirectory, including ones
+// created later, and reports names relative to `dir` (e.g. "css/app.css").
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::string& name, uint32_t mask)>;
+
+    FileWatcher(const std::string& dir, uint32_t mask, Callback callback,
+                std::chrono::milliseconds settle = std::chrono::milliseconds(0),
+                bool recursive = false);
+    ~FileWatcher();
+
+    // Returns false if inotify is unavailable or the directory cannot be watched
+    bool start();
+    void stop();
+
+private:
+    void run();
+    // Adds a watch on dir_/rel and, when recursive, on everything below it
+    bool add_watch(const std::string& rel);
+    void remove_watches(const std::string& rel);
+
+    std::string dir_;
+    uint32_t mask_;
+    Callback callback_;
+    std::chrono::milliseconds settle_;
+    bool recursive_;
+    int fd_ = -1;
+    std::unordered_map<int, std::string> watches_;   // wd -> path relative to dir_
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
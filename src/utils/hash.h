@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+// FNV-1a 64-bit content hash. Not cryptographic; used for content
+// fingerprints and the ETags derived from them.
+inline uint64_t fnv1a_64(const char* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL) {
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+inline uint64_t fnv1a_64(const std::string& s) {
+    return fnv1a_64(s.data(), s.size());
+}
+
+inline std::string hash_to_hex(uint64_t h) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
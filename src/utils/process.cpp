@@ -0,0 +1,155 @@
+#include "utils/process.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+
+// Fork and exec argv. The child's stdin comes from *in_fd (or /dev/null
+// when in_fd is null) and its stdout goes to *out_fd; both are the
+// parent's ends of fresh pipes. Returns the pid, or -1.
+pid_t spawn_child(const std::vector<std::string>& argv, int niceness, int* in_fd, int* out_fd) {
+    if (argv.empty()) return -1;
+
+    int out_pipe[2], in_pipe[2] = {-1, -1};
+    if (pipe2(out_pipe, O_CLOEXEC) != 0) return -1;
+    if (in_fd && pipe2(in_pipe, O_CLOEXEC) != 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        return -1;
+    }
+
+    std::vector<char*> args;
+    for (const auto& a : argv) args.push_back(const_cast<char*>(a.c_str()));
+    args.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        if (in_fd) {
+            close(in_pipe[0]);
+            close(in_pipe[1]);
+        }
+        return -1;
+    }
+
+    if (pid == 0) {
+        int devnull = open("/dev/null", O_RDWR);
+        dup2(in_fd ? in_pipe[0] : devnull, STDIN_FILENO);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        if (devnull >= 0) dup2(devnull, STDERR_FILENO);
+        if (niceness != 0) setpriority(PRIO_PROCESS, 0, niceness);
+        execvp(args[0], args.data());
+        _exit(127);
+    }
+
+    close(out_pipe[1]);
+    *out_fd = out_pipe[0];
+    if (in_fd) {
+        close(in_pipe[0]);
+        *in_fd = in_pipe[1];
+    }
+    return pid;
+}
+
+} // anonymous namespace
+
+ChildProcess::~ChildProcess() {
+    if (pid_ > 0) {
+        terminate();
+        wait();
+    }
+}
+
+bool ChildProcess::spawn(const std::vector<std::string>& argv, int niceness) {
+    pid_ = spawn_child(argv, niceness, nullptr, &out_fd_);
+    return pid_ > 0;
+}
+
+void ChildProcess::terminate() {
+    if (pid_ > 0) kill(pid_, SIGTERM);
+}
+
+int ChildProcess::wait() {
+    if (out_fd_ >= 0) {
+        close(out_fd_);
+        out_fd_ = -1;
+    }
+    if (pid_ <= 0) return -1;
+
+    int status = 0;
+    while (waitpid(pid_, &status, 0) < 0 && errno == EINTR) {}
+    pid_ = -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+int run_capture(const std::vector<std::string>& argv, std::string& output,
+                const ProcessOptions& options) {
+    int in_fd = -1, out_fd = -1;
+    pid_t pid = spawn_child(argv, options.niceness, &in_fd, &out_fd);
+    if (pid < 0) return 127;
+
+    fcntl(in_fd, F_SETFL, O_NONBLOCK);
+
+    size_t written = 0;
+    if (options.input.empty()) {
+        close(in_fd);
+        in_fd = -1;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + options.timeout;
+    bool timed_out = false;
+    char buf[65536];
+
+    while (out_fd >= 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            timed_out = true;
+            break;
+        }
+
+        pollfd fds[2];
+        int nfds = 0;
+        fds[nfds++] = {out_fd, POLLIN, 0};
+        if (in_fd >= 0) fds[nfds++] = {in_fd, POLLOUT, 0};
+
+        int ready = poll(fds, nfds, static_cast<int>(remaining));
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+
+        if (fds[0].revents) {
+            ssize_t n = read(out_fd, buf, sizeof(buf));
+            if (n > 0) {
+                output.append(buf, n);
+            } else if (n == 0 || errno != EAGAIN) {
+                close(out_fd);
+                out_fd = -1;
+            }
+        }
+        if (nfds > 1 && fds[1].revents) {
+            ssize_t n = write(in_fd, options.input.data() + written, options.input.size() - written);
+            if (n > 0) written += n;
+            if (n < 0 && errno != EAGAIN) written = options.input.size();
+            if (written >= options.input.size()) {
+                close(in_fd);
+                in_fd = -1;
+            }
+        }
+    }
+
+    if (in_fd >= 0) close(in_fd);
+    if (out_fd >= 0) close(out_fd);
+    if (timed_out) kill(pid, SIGKILL);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+    if (timed_out) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
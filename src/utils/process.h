@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+struct ProcessOptions {
+    std::string input;                  // written to the child's stdin
+    int niceness = 0;                   // applied in the child before exec
+    std::chrono::milliseconds timeout{10000};
+};
+
+// A long-running child whose stdout is read by the caller
+class ChildProcess {
+public:
+    ChildProcess() = default;
+    ~ChildProcess();
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    // Start argv[0] (PATH lookup, no shell) with stdin from /dev/null
+    bool spawn(const std::vector<std::string>& argv, int niceness = 0);
+
+    int stdout_fd() const { return out_fd_; }
+
+    // SIGTERM the child; stdout then reaches EOF
+    void terminate();
+
+    // Reap the child and close its stdout; returns the exit status
+    int wait();
+
+private:
+    int pid_ = -1;
+    int out_fd_ = -1;
+};
+
+// Run argv[0] (looked up in PATH, no shell) and capture its stdout.
+// Returns the exit status, 127 if it could not be started, or -1 on timeout.
+int run_capture(const std::vector<std::string>& argv, std::string& output,
+                const ProcessOptions& options = {});
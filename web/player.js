@@ -1,4 +1,5 @@
 const HLS_SRC = '/hls/stream.m3u8';
+const LL_HLS_SRC = '/hls/ll/stream/index.m3u8';
 const STATUS_API = '/api/status';
 
 const video = document.getElementById('video');
@@ -7,17 +8,50 @@ const viewersEl = document.getElementById('viewers');
 
 let retryTimer = null;
 let hls = null;
+let starting = false;
+
+// Low-latency (LL-HLS / CMAF) mode is used when the server offers it,
+// unless the page is opened with ?latency=standard
+async function lowLatencyAvailable() {
+    if (new URLSearchParams(location.search).get('latency') === 'standard') return false;
+    try {
+        const res = await fetch(LL_HLS_SRC, { method: 'HEAD' });
+        return res.ok;
+    } catch {
+        return false;
+    }
+}
+
+async function startPlayer() {
+    // The retry timer and the status poll can both call this; the probe
+    // below is async, so guard against building two players at once
+    if (starting || (hls && hls.media)) return;
+    starting = true;
+    let lowLatency;
+    try {
+        lowLatency = await lowLatencyAvailable();
+    } finally {
+        starting = false;
+    }
+    if (hls) {
+        hls.destroy();
+        hls = null;
+    }
+    const src = lowLatency ? LL_HLS_SRC : HLS_SRC;
 
-function startPlayer() {
     if (Hls.isSupported()) {
-        hls = new Hls({
+        hls = new Hls(lowLatency ? {
+            enableWorker: true,
+            lowLatencyMode: true,
+            backBufferLength: 30,
+        } : {
             enableWorker: true,
             lowLatencyMode: false,
             backBufferLength: 300,
             liveSyncDurationCount: 5,
             liveMaxLatencyDurationCount: 10,
         });
-        hls.loadSource(HLS_SRC);
+        hls.loadSource(src);
         hls.attachMedia(video);
 
         hls.on(Hls.Events.MANIFEST_PARSED, () => {
@@ -35,8 +69,8 @@ function startPlayer() {
             }
         });
     } else if (video.canPlayType('application/vnd.apple.mpegurl')) {
-        // Safari native HLS
-        video.src = HLS_SRC;
+        // Safari native HLS (supports LL-HLS as well)
+        video.src = src;
         video.addEventListener('loadedmetadata', () => {
             setLive();
             video.play().catch(() => {});